@@ -7,158 +7,302 @@
  *  @date    2/6/2012
  */
 #include "SAE_AutoShifter.h"
+#include "shift.h"
+#include "btn_event.h"
+#include "calib.h"
+#include "plant.h"
+#include "prof.h"
+#include "sched.h"
+#include "bbox.h"
 
-// Update Button States (1ms)
-ISR(TIMER0_COMPA_vect)
+volatile uint32_t sys_ms;
+uint8_t cur_adc;
+enum Mode mode;
+Tach tach;
+Seqlock sensor_lock;
+Usr_Btns btns;
+const Gear gears[MAX_GEARS] =
+{
+    {1, 0,         &gears[1]},
+    {2, &gears[0], &gears[2]},
+    {3, &gears[1], &gears[3]},
+    {4, &gears[2], &gears[4]},
+    {5, &gears[3], 0}
+};
+const Gear *gear_;
+uint8_t throttle_pos;
+static Timer input_timer;   ///<Button port debounce
+static Timer tach_timer;    ///<Stall check or pulse count sample
+static uint8_t forced = MODE_SWITCH;    ///<Mode set by mode_force()
+
+void tach_init(void)
 {
-    // Upshift button
-    if(!(BTN_IP_PIN & _BV(USHIFT_PIN)))
+    tach.k = 60000000UL/calib.pulse_rot;
+    tach.min_period = tach.k/TACH_RPM_LIMIT;
+}
+
+/**
+ * @brief Record a new rpm sample taken at @c us and filter it.
+ */
+static inline void tach_record(uint16_t rpms, uint32_t us)
+{
+    seqlock_write_begin(&sensor_lock);
+    tach.rpms = rpms;
+    tach.us = us;
+    // Stalled: the filters must not hold on to the running rpm
+    if(!rpms)
+        rpm_filter_reset(&tach.filt);
+    rpm_filter_update(&tach.filt, rpms, us);
+    seqlock_write_end(&sensor_lock);
+    sched_post(TASK_SHIFT);
+#ifdef BLACKBOX
     {
-        if(++up_shift.count >= DB_DELAY && up_shift.state == RELEASED)
-            up_shift.state = PRESSED;
-    }else
+        static uint16_t logged;
+
+        if((uint16_t)sys_ms - logged >= BBOX_RPM_MS)
+        {
+            logged = sys_ms;
+            bbox_log(BBOX_RPM, rpms);
+        }
+    }
+#endif
+}
+
+#if TACH_MODE == TACH_PERIOD
+/**
+ * @brief Timer: stall timeout, every ms.
+ *
+ * With no edge for #TACH_STALL_MS the engine is taken to be stopped.
+ */
+static void tach_tick(void *arg)
+{
+    uint8_t sreg = SREG;
+    uint32_t now;
+
+    (void)arg;
+    // INT0 writes the same fields
+    cli();
+    now = micros_isr();
+    if(tach.running && now - tach.last_us > TACH_STALL_MS*1000UL)
     {
-        up_shift.count = 0;
-        up_shift.state = RELEASED;
+        tach.running = 0;
+        tach.period = 0;
+        tach_record(0, now);
     }
-    
-    // Downshift button
-    if(!(BTN_IP_PIN & _BV(DSHIFT_PIN)))
+    SREG = sreg;
+}
+#else
+/**
+ * @brief Timer: tachometer sample, every #TACH_SAMPLE_MS.
+ *
+ * Converts the pulses INT0 counted since the last sample into rpm.
+ */
+static void tach_tick(void *arg)
+{
+    uint8_t sreg = SREG;
+
+    (void)arg;
+    cli();
+    //rpms = pulses/[pulses/rotation]*[samples/min]
+    //32 bit: 16 bit overflows above 546 pulses per sample
+    tach_record((uint32_t)tach.pulse*60000/TACH_SAMPLE_MS/calib.pulse_rot,
+                micros_isr());
+
+    //reset pulse so we can start count over
+    tach.pulse = 0;
+    SREG = sreg;
+}
+#endif  /* TACH_MODE */
+
+#ifdef SIMULATE
+/**
+ * @brief Run the plant model for a millisecond.
+ *
+ * The plant sees the ignition and solenoid outputs as they are now, and
+ * its tachometer pulses are written to #TACH_PIN, which is an output in
+ * this build. INT0 fires on the output edge as it would on a real one, so
+ * the rpm go through the normal measurement. Each pulse is placed within
+ * the millisecond by the Timer0 compare B interrupt; at most one pulse is
+ * made per millisecond.
+ */
+static inline void sim_tick(void)
+{
+    static uint32_t phase;  // Pulses due, in 1/60000 of a pulse
+    uint32_t step;
+    uint8_t out = 0;
+
+    if(ECU_PORT & _BV(IGNITION_INT))
+        out |= PLANT_IGN_CUT;
+    if(SOLEN_OP_PORT & _BV(SOLEN_UP))
+        out |= PLANT_SOLEN_UP;
+    if(SOLEN_OP_PORT & _BV(SOLEN_DN))
+        out |= PLANT_SOLEN_DN;
+    plant_step(cur_adc, out);
+
+    ECU_PORT &= ~_BV(TACH_PIN);
+    step = (uint32_t)plant.rpm*calib.pulse_rot;
+    if(phase + step >= 60000)
     {
-        if(++dn_shift.count >= DB_DELAY && dn_shift.state == RELEASED)
-            dn_shift.state = PRESSED;
+        // Where in this millisecond the pulse falls
+        uint8_t at = (60000 - phase)*(OCR0A+1UL)/step;
+
+        phase = phase + step - 60000;
+        if(phase >= 60000)
+            phase = 0;      // Falling behind: drop the backlog
+        if(at <= TCNT0 + 1)
+            ECU_PORT |= _BV(TACH_PIN);
+        else
+        {
+            OCR0B = at;
+            TIFR0 = _BV(OCF0B);
+            TIMSK0 |= _BV(OCIE0B);
+        }
     }else
-    {
-        dn_shift.count = 0;
-        dn_shift.state = RELEASED;
-    }
+        phase += step;
+}
 
-    // Mode button
-    if(!(BTN_IP_PIN & _BV(SEMIAUTO_PIN)))
-        mode = semi_man;
-    else if(!(BTN_IP_PIN & _BV(AUTOMATIC_PIN)))
-        mode = automated;
-    else
-        mode = manual;
+// Simulated tachometer edge
+ISR(TIMER0_COMPB_vect)
+{
+    TIMSK0 &= ~_BV(OCIE0B);
+    ECU_PORT |= _BV(TACH_PIN);
+}
+#endif  /* SIMULATE */
+
+/**
+ * @brief Queue a paddle event and wake #TASK_PADDLE for it.
+ */
+static inline void paddle_event(uint8_t type, uint8_t pin, uint16_t now)
+{
+    btn_event_push(type, pin, now);
+    sched_post(TASK_PADDLE);
+    BBOX_LOG(BBOX_PADDLE, (uint16_t)type << 8 | pin);
 }
 
-ISR(ADC_vect)
+/**
+ * @return the #Mode the debounced switch pins select
+ */
+static inline enum Mode mode_switch(uint8_t state)
 {
-    uint8_t adc = ADCH;
-    cur_adc = ADCH;
-    if(adc <= 50)
-        throttle_pos = 0;
-    else if(adc <= 80)
-        throttle_pos = 1;
-    else if(adc <= 114)
-        throttle_pos = 2;
-    else if(adc <= 149)
-        throttle_pos = 3;
-    else if(adc <= 184)
-        throttle_pos = 4;
-    else
-        throttle_pos = 5;
+    if(state & _BV(SEMIAUTO_PIN))
+        return semi_man;
+    if(state & _BV(AUTOMATIC_PIN))
+        return automated;
+    return manual;
 }
 
-// Tachometer sample time (1s)
-ISR(TIMER1_COMPA_vect)
+/**
+ * @brief Timer: debounce the button port.
+ *
+ * A paddle press or release is reported once the pin has read the same
+ * for #DEBOUNCE_SAMPLES samples, and a long press once the paddle has
+ * been held for #BTN_LONG_PRESS_MS. The mode switch follows its
+ * debounced pins, so it cannot flicker mid-shift.
+ */
+static void input_tick(void *arg)
 {
-//#ifdef DEBUG
-    static uint8_t tick=0;///<DEBUG variable - system tick
-    if(++tick >= 2)
-    {
-        canPrint = 1;
-        tick = 0;
-    }
-  static uint8_t prev_pos = 0;
-//#endif
-/*
-  switch(throttle_pos)
-  {
-      case 4:
-        tach.rpms += 30;
-      case 3:
-        tach.rpms += 20;
-      case 2:
-        tach.rpms += 10;
-      case 1:
-        tach.rpms += 5;
-      case 0:
-        if(tach.rpms <=30)
-            tach.rpms = 0;
-        else
-            tach.rpms -= 30;
-  }
-*/
+    uint16_t now = timer_now();
+    uint8_t changed = debounce(&btns.db, ~BTN_IP_PIN);
+    uint8_t pressed = btns.db.state & BTN_PADDLES;
+    uint8_t todo = (changed | (pressed & ~btns.long_sent)) & BTN_PADDLES;
 
-    switch(throttle_pos)
+    (void)arg;
+    // Only the paddles with something to report
+    for(uint8_t pin = 0; todo; ++pin, todo >>= 1)
     {
-        case 4:
-            if(throttle_pos < prev_pos)
-                if(tach.rpms > gear_->decrease[throttle_pos])
-                    tach.rpms -= gear_->decrease[throttle_pos];
-            else
-            //if(tach.rpms <= gear_upper())
-                    tach.rpms += gear_->increase[throttle_pos];
-            break;
-        case 3:
-            if(throttle_pos==0 || throttle_pos < prev_pos)
-            {
-                if(tach.rpms > gear_->decrease[throttle_pos])
-                    tach.rpms -= gear_->decrease[throttle_pos];
-            }else
-            {
-                //if(tach.rpms <= gear_upper())
-                    tach.rpms += gear_->increase[throttle_pos];
-            }
-            break;
-        case 2:
-            if(throttle_pos==0 || throttle_pos < prev_pos)
-            {
-                if(tach.rpms > gear_->decrease[throttle_pos])
-                    tach.rpms -= gear_->decrease[throttle_pos];
-            }else
-            {
-                //if(tach.rpms <= gear_upper())
-                    tach.rpms += gear_->increase[throttle_pos];
-            }   
-            break;
-        case 1:
-            if(throttle_pos==0 || throttle_pos < prev_pos)
+        uint8_t bit = _BV(pin);
+
+        if(!(todo & 1))
+            continue;
+        if(changed & bit)
+        {
+            if(pressed & bit)
             {
-                if(tach.rpms > gear_->decrease[throttle_pos])
-                    tach.rpms -= gear_->decrease[throttle_pos];
+                btns.since[pin] = now;
+                btns.long_sent &= ~bit;
+                paddle_event(BTN_PRESS, pin, now);
             }else
-            {
-                //if(tach.rpms <= gear_upper())
-                    tach.rpms += gear_->increase[throttle_pos];
-            }
-            break;
-        case 0:
-                if(tach.rpms > gear_->decrease[throttle_pos])
-                    tach.rpms -= gear_->decrease[throttle_pos];
-            break;
-        default:
-            break;
+                paddle_event(BTN_RELEASE, pin, now);
+        }else if(now - btns.since[pin] >= BTN_LONG_PRESS_MS)
+        {
+            btns.long_sent |= bit;
+            paddle_event(BTN_LONG_PRESS, pin, now);
+        }
     }
-    prev_pos = throttle_pos;
-  /*
-//#endif
-    //rpms = pulses/[pulses/rotation]*[sample freq]*[60s/min]
-    tach.rpms = tach.pulse*60*TIMER1_FREQ/PULSE_ROT; //rot/min
-    tach.rpms_hist[tach.index] = tach.rpms;
-    
-    if(++tach.index == 10)
-        tach.index = 0;
-   
-    //reset pulse so we can start count over
-    tach.pulse = 0;
-    */
+
+    if((changed & BTN_MODE_PINS) && forced == MODE_SWITCH)
+    {
+        mode = mode_switch(btns.db.state);
+        BBOX_LOG(BBOX_MODE, mode);
+    }
+}
+
+void btn_debounce(uint8_t ms)
+{
+    uint16_t period = (ms + DEBOUNCE_SAMPLES/2)/DEBOUNCE_SAMPLES;
+
+    calib.db_ms = ms;
+    timer_start(&input_timer, 1, period ? period : 1, input_tick, 0);
+}
+
+void mode_force(uint8_t m)
+{
+    forced = m;
+    mode = m == MODE_SWITCH ? mode_switch(btns.db.state) : m;
+    BBOX_LOG(BBOX_MODE, mode);
+}
+
+void inputs_start(void)
+{
+    debounce_init(&btns.db, ~BTN_IP_PIN & BTN_MODE_PINS);
+    btns.long_sent = 0;
+    mode = mode_switch(btns.db.state);
+    btn_debounce(calib.db_ms);
+#if TACH_MODE == TACH_PERIOD
+    timer_start(&tach_timer, 1, 1, tach_tick, 0);
+#else
+    timer_start(&tach_timer, TACH_SAMPLE_MS, TACH_SAMPLE_MS, tach_tick, 0);
+#endif
 }
-// Pulse counter
+
+// System tick (1ms)
+ISR(TIMER0_COMPA_vect)
+{
+    PROF_ISR_BEGIN(PROF_TIMER0);
+    ++sys_ms;
+#ifdef SIMULATE
+    sim_tick();
+#endif
+    timer_tick();
+    PROF_ISR_END(PROF_TIMER0);
+}
+
+// Tachometer edge
 ISR(INT0_vect)
-{/*
+{
+    PROF_ISR_BEGIN(PROF_INT0);
+#if TACH_MODE == TACH_PERIOD
+    uint32_t now = micros_isr();
+    uint32_t period = now - tach.last_us;
+
+    // Minimum period gate: too fast to be a real pulse
+    if(period < tach.min_period)
+        ++tach.glitches;
+    // First edge after a stall only starts the clock
+    else if(!tach.running)
+    {
+        tach.last_us = now;
+        tach.running = 1;
+    }else
+    {
+        tach.last_us = now;
+        tach.period = period;
+        //rpms = [60s/min]*[us/s]/[pulses/rotation]/[us/pulse], rounded
+        tach_record((tach.k + period/2)/period, now);
+    }
+#else
 //    BOARD_PIN |= _BV(BOARD_LIGHT);
     ++tach.pulse;
-    */
+#endif  /* TACH_MODE */
+    PROF_ISR_END(PROF_INT0);
 }
@@ -17,169 +17,273 @@
 
 #include <stdio.h>
 #include <stdint.h>
-#include <avr/interrupt.h>
 #include "defines.h"
 #include "delay_rg.h"
+#include "rpm_filter.h"
+#include "shiftmap.h"
+#include "debounce.h"
+#include "seqlock.h"
 
-uint8_t cur_adc;
-uint8_t canPrint = 0;   ///<DEBUG variable - print flag
+extern uint8_t cur_adc;    ///<Throttle, 8 bits, see adc.h
+extern uint8_t throttle_pos;   ///<Throttle band, see adc.h
 ///Mode of the system
-enum Mode {manual, semi_man, automated}mode;///< Mode switch
+enum Mode {manual, semi_man, automated};
+#define MODE_SWITCH 3   ///<mode_force(): follow the mode switch again
+extern enum Mode mode;  ///< Mode switch
+
+/** @defgroup clock System Clock
+ *  Milliseconds since boot, counted by the #TIMER0_FREQ system tick.
+ *  @{
+ */
+extern volatile uint32_t sys_ms;    ///<Milliseconds since boot
+
+/**
+ * millis()
+ *
+ * @return milliseconds since boot. Safe to call with interrupts enabled.
+ */
+static inline uint32_t millis(void)
+{
+    uint8_t sreg = SREG;
+    uint32_t ms;
+
+    cli();
+    ms = sys_ms;
+    SREG = sreg;
+    return ms;
+}
+
+/**
+ * micros_isr()
+ *
+ * Combines #sys_ms with the Timer0 count, so the resolution is
+ * #TIMER0_US_PER_TICK. Interrupts must be disabled, as they are in an ISR.
+ *
+ * @return microseconds since boot
+ */
+static inline uint32_t micros_isr(void)
+{
+    uint32_t ms = sys_ms;
+    uint8_t cnt = TCNT0;
+
+    // Compare match not serviced yet: the count has already wrapped
+    if(TIFR0 & _BV(OCF0A))
+    {
+        cnt = TCNT0;
+        ++ms;
+    }
+    return ms*1000 + cnt*TIMER0_US_PER_TICK;
+}
+
+/**
+ * micros()
+ *
+ * @return microseconds since boot. Safe to call with interrupts enabled.
+ */
+static inline uint32_t micros(void)
+{
+    uint8_t sreg = SREG;
+    uint32_t us;
+
+    cli();
+    us = micros_isr();
+    SREG = sreg;
+    return us;
+}
+//@}
 
 /** @defgroup tacho Tachometer
  *  Holds the tach pulses and rpm conversion.
- *  @c rpms update at #TIMER1_FREQ
+ *  With #TACH_COUNT, @c rpms update every #TACH_SAMPLE_MS from a pulse
+ *  count.
+ *  With #TACH_PERIOD, every edge is timed against micros() and @c rpms
+ *  update on each pulse. Each sample also runs the filter pipeline in
+ *  rpm_filter.h; a 0 sample, a stall or a count with no pulse, starts it
+ *  over so the filtered rpm drop to 0 at once. Samples are published
+ *  under #sensor_lock, and the main task reads them, with the throttle,
+ *  through sensor_snapshot().
  *  @{
  */
 typedef struct
 {
-    uint16_t pulse;
-    uint16_t rpms;
-    uint8_t  index;
-    uint16_t rpms_hist[RPM_HIST_LEN];
-    uint16_t ave;
+    uint16_t pulse;     ///< Pulses counted this sample (#TACH_COUNT)
+    uint16_t rpms;      ///< Last raw sample
+    uint32_t us;        ///< Time of the last sample
+    Rpm_Filter filt;    ///< Filtered rpm
+    uint32_t k;         ///< 60e6/pulses per rotation, rpm = k/period
+    uint32_t min_period;///< Shortest accepted period (us), #TACH_RPM_LIMIT
+    uint32_t last_us;   ///< Time of the last accepted edge (#TACH_PERIOD)
+    uint32_t period;    ///< Last pulse period (us), 0 when stalled
+    uint8_t  running;   ///< An edge has been seen since the last stall
+    uint8_t  glitches;  ///< Edges rejected as too fast
 } Tach;
 
-Tach tach;  ///<Tachometer object
+extern Tach tach;  ///<Tachometer object
+extern Seqlock sensor_lock; ///<Guards the tachometer outputs and the ADC
 
 /**
- * update_ave_rpms()
- * Updates the Tach rpm variable
+ * tach_init()
+ * Sets the rpm conversion from the calibration. Call after calib_load().
  */
-inline void update_ave_rpms()
+void tach_init(void);
+
+/// A coherent copy of the sensor outputs the ISRs publish.
+typedef struct
 {
-    uint32_t sum = 0;
+    uint16_t rpms;      ///< Last raw sample
+    uint16_t median;    ///< Spike-rejected rpm
+    uint16_t ave;       ///< Moving average rpm
+    uint16_t ema;       ///< Exponential moving average rpm
+    int16_t  slope;     ///< Rate of change (rpm/s)
+    uint32_t us;        ///< Time of the last sample
+    uint8_t  adc;       ///< Throttle, #cur_adc
+    uint8_t  throttle;  ///< Throttle band, #throttle_pos
+} Sensor_Snapshot;
 
-    for(int i = 0; i < RPM_HIST_LEN; ++i)
-        sum += tach.rpms_hist[i];
+/**
+ * sensor_snapshot()
+ * Copies every tachometer output from the same sample, and the throttle,
+ * without disabling interrupts. Main context only.
+ *
+ * @var s   Where to store the copy
+ */
+static inline void sensor_snapshot(Sensor_Snapshot *s)
+{
+    uint8_t seq;
 
-    tach.ave = sum/RPM_HIST_LEN;
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        s->rpms     = tach.rpms;
+        s->median   = tach.filt.median;
+        s->ave      = tach.filt.ave;
+        s->ema      = tach.filt.ema;
+        s->slope    = tach.filt.slope;
+        s->us       = tach.us;
+        s->adc      = cur_adc;
+        s->throttle = throttle_pos;
+    }while(seqlock_read_retry(&sensor_lock, seq));
 }
 
 /**
  * average_rpms()
  * Returns the Tach's average rpm variable
  */
-inline uint16_t average_rpms()
+static inline uint16_t average_rpms(void)
+{
+    uint16_t rpms;
+    uint8_t seq;
+
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        rpms = tach.filt.ave;
+    }while(seqlock_read_retry(&sensor_lock, seq));
+    return rpms;
+}
+
+/**
+ * median_rpms()
+ * Returns the Tach's spike-rejected rpm
+ */
+static inline uint16_t median_rpms(void)
 {
-    return tach.ave;
+    uint16_t rpms;
+    uint8_t seq;
+
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        rpms = tach.filt.median;
+    }while(seqlock_read_retry(&sensor_lock, seq));
+    return rpms;
 }
-inline uint16_t cur_rpms()
+
+static inline uint16_t cur_rpms(void)
 {
-    return tach.rpms;
+    uint16_t rpms;
+    uint8_t seq;
+
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        rpms = tach.rpms;
+    }while(seqlock_read_retry(&sensor_lock, seq));
+    return rpms;
 }
 
 //@}
 
 /** @defgroup usrBtns User Buttons
- *  The states of the buttons, debounce values, and related functions.
+ *  Every pin of #BTN_IP_PIN is debounced at once by the vertical counters
+ *  in debounce.h, one sample every @c calib.db_ms/#DEBOUNCE_SAMPLES ms:
+ *  the paddles, whose edges go to the main task through the queue in
+ *  btn_event.h, and the mode switch.
  *  @{
  */
 typedef struct
 {
-    uint8_t state;  ///< Button state. Either #PRESSED or #RELEASED
-    uint16_t count; ///< Button Press count.
+    Debounce db;        ///< Debounced port, 1 = pressed (pin low)
+    uint8_t  long_sent; ///< Held paddles whose long press has been reported
+    uint16_t since[8];  ///< When each paddle was pressed (ms)
 } Usr_Btns;
 
-Usr_Btns up_shift,  ///< Upshift button
-         dn_shift;  ///< Downshift button
+extern Usr_Btns btns;   ///< The button port
 
 /**
  * btn_state()
  *
- * @return the @c state of @c u_btn
+ * @return #PRESSED or #RELEASED, the debounced state of @c pin
  */
-inline uint8_t btn_state(Usr_Btns *u_btn)
+static inline uint8_t btn_state(uint8_t pin)
 {
-    return u_btn->state;
+    return btns.db.state & _BV(pin) ? PRESSED : RELEASED;
 }
+
 /**
- * btn_cout()
- *
- * @return the press @c count of @c u_btn
+ * inputs_start()
+ * Starts the timers that debounce the button port and check the
+ * tachometer for a stall (#TACH_PERIOD) or sample its pulse count
+ * (#TACH_COUNT). The mode switch is taken as settled where it is now.
+ * Call after timer_init().
  */
-inline uint16_t btn_count(Usr_Btns *u_btn)
-{
-    return u_btn->count;
-}
+void inputs_start(void);
 
 /**
- * onRelease()
- * The on-release handler for @c btn
- *
- * @return  False if buton is not pressed
- * @return  True when the button is pressed and released
- *
- * @var btn The button to handle
+ * btn_debounce()
+ * Sets @c calib.db_ms to @c ms and the sample period to match.
  */
-inline uint8_t onRelease(Usr_Btns *btn)
-{
-    if(btn->state == RELEASED)
-        return 0;
-    if(btn->state == PRESSED)
-        while(btn->state == PRESSED)
-            delay_us(1);
-    
-    return 1;
-}
+void btn_debounce(uint8_t ms);
+
+/**
+ * mode_force()
+ * Overrides the mode switch with @c m, for tests, until called again with
+ * #MODE_SWITCH.
+ */
+void mode_force(uint8_t m);
 
 //@}
 /** defgroup gears Gears
  *  Defines the gear structure and related functions.
+ *  The gearbox is a constant table; shift points come from the flash shift
+ *  map in shiftmap.h, looked up by gear number and throttle.
  *  @{
  */
 typedef struct Gear{
     uint8_t     g_num;     ///< Number of the Gear
-    uint16_t    lowerB;    ///< Lower bound of Gear
-    uint16_t    upperB;    ///< Upper bound of Gear
-    uint16_t    cruise;    ///< Cruise RPM level
-    struct Gear *prev;     ///< Previous gear
-    struct Gear *next;     ///< Next gear
-    uint16_t    increase[MAX_GEARS];///< rpm increase levels
-    uint16_t    decrease[MAX_GEARS];///< rpm decrease levels
+    const struct Gear *prev;   ///< Previous gear
+    const struct Gear *next;   ///< Next gear
 }Gear;
 
-Gear *gear_;               ///<Current gear
-uint8_t throttle_pos;
-/**
- * Gear_Const()
- * Constructor for Gear Object
- *
- * @var this    the Gear to construct
- * @var num     Gear number
- * @var lower   Lower bound for Gear
- * @var upper   Upper bound for Gear
- * @var p       Previous Gear
- * @var n       Next Gear
- */
-inline void Gear_Construct(Gear *this, uint8_t num, uint16_t lower,
-                        uint16_t upper, uint16_t cruise, Gear *p,Gear *n)
-{
-    this->g_num = num;
-    this->lowerB = lower;
-    this->upperB = upper;
-    this->cruise = cruise;
-    this->prev = p;
-    this->next = n;
-}
-
-inline void Gear_IncreaseLevels(Gear *this, uint16_t levels[])
-{
-    for(int i=0; i<MAX_GEARS;++i)
-        this->increase[i] = levels[i];
-}
+extern const Gear gears[MAX_GEARS];    ///<The gearbox
+extern const Gear *gear_;  ///<Current gear
 
-inline void Gear_DecreaseLevels(Gear *this, uint16_t levels[])
-{
-    for(int i=1; i<MAX_GEARS;++i)
-        this->decrease[i] = levels[i];
-}
 /**
  * gear_num()
  * 
  * @return the number of the current gear
  */
-inline uint8_t gear_num()
+static inline uint8_t gear_num(void)
 {
     return gear_->g_num;
 }
@@ -187,122 +291,53 @@ inline uint8_t gear_num()
 /**
  * gear_upper()
  *
- * @return The upper bound of the current gear
+ * @return The upshift rpm of the current gear at the current throttle
  */
-inline uint16_t gear_upper()
+static inline uint16_t gear_upper(void)
 {
-    return gear_->upperB;
+    return shiftmap_up(gear_->g_num, cur_adc);
 }
 
 /**
  * gear_lower()
  *
- * @return The lower bound of the current gear
+ * @return The downshift rpm of the current gear at the current throttle
  */
-inline uint16_t gear_lower()
+static inline uint16_t gear_lower(void)
 {
-    return gear_->lowerB;
+    return shiftmap_down(gear_->g_num, cur_adc);
 }
+//@}
 
-/**
- * shift()
- * Shift gear in the desired @c direction
- *
- * @var direction   The direction to shift
+/** @defgroup mainTask Main Task
+ *  The main task is split into an initialization and a single iteration so
+ *  the host build can drive it one step at a time.
+ *  @{
  */
-inline void shift(uint8_t direction)
-{
-    ECU_PORT |= _BV(IGNITION_INT);
-    delay_ms(IGNITION_DLY);
-    SOLEN_OP_PORT |= _BV(direction);
-    delay_ms(SOLEN_DLY);
-    SOLEN_OP_PORT &= ~_BV(direction);
-    delay_ms(IGNITION_DLY);
-    ECU_PORT &= ~_BV(IGNITION_INT);
-
-    cli();
-//#ifdef SIMULATE
-    int next_rpms;
-    switch(direction)
-    {
-        case SOLEN_UP:
-            switch(gear_->g_num)
-            {
-                case 1:
-                    tach.rpms -= 60;
-                    break;
-                case 2:
-                    tach.rpms -= 60;
-                    break;
-                case 3:
-                    tach.rpms -= 60;
-                    break;
-                case 4:
-                    tach.rpms -= 60;
-                    break;
-                default:
-                    //Shifting up in 5th gear not allowed...
-                    break;
-            }
-        case SOLEN_DN:
-            switch(gear_->g_num)
-            {
-                case 1:
-                case 2:
-                    tach.rpms += 60;
-                    break;
-                case 3:
-                    tach.rpms += 60;
-                    break;
-                case 4:
-                    tach.rpms += 60;
-                    break;
-                case 5:
-                    tach.rpms += 60;
-                    break;
-                default:
-                    break;
-            }
-    }
-    sei();
-//#endif  /* SIMULATE */
-}
+void shifter_init(void);
+void shifter_step(void);
 //@}
 
 /** 
- *  @brief  Update the button states.
+ *  @brief  System tick: advance #sys_ms and the timer wheel, see timer.h.
  *
  *  Fires at #TIMER0_FREQ Hz.
  */
 ISR(TIMER0_COMPA_vect);
 
-//#ifdef SIMULATE
+#ifdef SIMULATE
 /**
- * @brief Converts position of external pedal to the change of rpms.
- *
- * This function converts the position of an external electric pedal using
- * the ADC. It uses the position of the pedal to describe the derrivative of
- * the engine's rpms over time.
+ *  @brief  Simulated tachometer edge, see plant.h.
  */
-ISR(ADC_vect);
-//#else
+ISR(TIMER0_COMPB_vect);
+#endif
+
 /**
  *  @brief  Count pulses from the tachometer.
  *  Fires at the rising edge of signal
- *  @par Counts the pulses from the tachometer until TIMER1 fires.
+ *  @par Times each pulse (#TACH_PERIOD), or counts the pulses until the
+ *  next sample (#TACH_COUNT).
  */
 ISR(INT0_vect);
-//#endif  /* SIMULATE */
-
-/** 
- *  @brief  Tachometer sample time. 
- *
- *  Fires at #TIMER1_FREQ Hz. (1ms) 
- *  @par Converts the number of pulses counted
- *  from the external interrupt into a value that represents the 
- *  instantaneous rpms of the engine. It also places the current rpms into 
- *  the history of rpms.
- */
-ISR(TIMER1_COMPA_vect);
 
 #endif  /* SAE_AUTOSHIFTER_H */
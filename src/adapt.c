@@ -0,0 +1,206 @@
+/**
+ *  @file
+ *  @brief Shift timings learned from the rpm around each shift.
+ *
+ *  @date    10/18/2026
+ */
+#include <stddef.h>
+#include "SAE_AutoShifter.h"
+#include "adapt.h"
+#include "calib.h"
+#include "bbox.h"
+
+#ifdef ADAPT
+
+/// The block lies between the calibration and the end of the EEPROM
+typedef char adapt_ee_check[
+    ADAPT_EE_ADDR >= CALIB_EE_ADDR + sizeof(Calib) &&
+    ADAPT_EE_ADDR + sizeof(Adapt) <= E2END + 1 ? 1 : -1];
+
+static Adapt    adapt;
+static uint8_t  streak[2][MAX_GEARS];   ///<Good shifts since the last change
+static uint8_t  tried[2][MAX_GEARS];    ///<Time shortened last, #ADAPT_HOLD_IGN
+static uint16_t changed_ms;             ///<When #adapt last changed
+static uint8_t  dirty;                  ///<#adapt differs from the EEPROM
+static uint8_t  saving;                 ///<Next byte to write + 1, 0 when idle
+
+/**
+ * @return the learned times of @c direction and @c gear
+ */
+static Adapt_Timing *timing(uint8_t direction, uint8_t gear)
+{
+    return &adapt.t[direction != SOLEN_UP][gear-1];
+}
+
+static uint8_t clamp(uint8_t v, uint8_t min, uint8_t max)
+{
+    return v < min ? min : v > max ? max : v;
+}
+
+/**
+ * @brief Note a change to #adapt; a save under way starts over.
+ */
+static void changed(void)
+{
+    dirty = 1;
+    saving = 0;
+    changed_ms = millis();
+}
+
+uint8_t adapt_valid(const Adapt *a)
+{
+    if(a->version != ADAPT_VERSION || a->size != sizeof(Adapt) ||
+       a->crc != calib_crc_block(a, offsetof(Adapt, crc)) ||
+       a->base_ign != calib.ign_ms || a->base_solen != calib.solen_ms)
+        return 0;
+
+    for(uint8_t d = 0; d < 2; ++d)
+        for(uint8_t i = 0; i < MAX_GEARS; ++i)
+        {
+            const Adapt_Timing *t = &a->t[d][i];
+
+            if(t->ign_ms < ADAPT_IGN_MIN || t->ign_ms > ADAPT_IGN_MAX ||
+               t->solen_ms < ADAPT_SOLEN_MIN || t->solen_ms > ADAPT_SOLEN_MAX)
+                return 0;
+        }
+    return 1;
+}
+
+uint8_t adapt_load(void)
+{
+    eeprom_read_block(&adapt, (const void *)ADAPT_EE_ADDR, sizeof(Adapt));
+    if(adapt_valid(&adapt))
+        return 1;
+
+    adapt_reset();
+    // Nothing learned yet, nothing worth an EEPROM write
+    dirty = 0;
+    return 0;
+}
+
+void adapt_reset(void)
+{
+    Adapt_Timing t;
+
+    t.ign_ms = clamp(calib.ign_ms, ADAPT_IGN_MIN, ADAPT_IGN_MAX);
+    t.solen_ms = clamp(calib.solen_ms, ADAPT_SOLEN_MIN, ADAPT_SOLEN_MAX);
+    t.held = 0;
+
+    adapt.version = ADAPT_VERSION;
+    adapt.size = sizeof(Adapt);
+    adapt.base_ign = calib.ign_ms;
+    adapt.base_solen = calib.solen_ms;
+    for(uint8_t d = 0; d < 2; ++d)
+        for(uint8_t i = 0; i < MAX_GEARS; ++i)
+        {
+            adapt.t[d][i] = t;
+            streak[d][i] = 0;
+            tried[d][i] = 0;
+        }
+    changed();
+}
+
+uint8_t adapt_ign_ms(uint8_t direction, uint8_t gear)
+{
+    return timing(direction, gear)->ign_ms;
+}
+
+uint8_t adapt_solen_ms(uint8_t direction, uint8_t gear)
+{
+    return timing(direction, gear)->solen_ms;
+}
+
+/**
+ * @brief Make one time of @c t a millisecond shorter, the one not tried
+ * last while both may go.
+ */
+static void shorten(Adapt_Timing *t, uint8_t *last)
+{
+    uint8_t ign = !(t->held & ADAPT_HOLD_IGN) && t->ign_ms > ADAPT_IGN_MIN;
+    uint8_t solen = !(t->held & ADAPT_HOLD_SOLEN) &&
+                    t->solen_ms > ADAPT_SOLEN_MIN;
+
+    if(solen && (!ign || *last == ADAPT_HOLD_IGN))
+    {
+        --t->solen_ms;
+        *last = ADAPT_HOLD_SOLEN;
+    }else if(ign)
+    {
+        --t->ign_ms;
+        *last = ADAPT_HOLD_IGN;
+    }else
+        return;
+    changed();
+}
+
+/**
+ * @brief Back off after a miss.
+ */
+static void lengthen(Adapt_Timing *t, uint8_t *last)
+{
+    if(*last & ADAPT_HOLD_IGN || !*last)
+        t->ign_ms = clamp(t->ign_ms + ADAPT_BACKOFF_MS, ADAPT_IGN_MIN,
+                          ADAPT_IGN_MAX);
+    if(*last & ADAPT_HOLD_SOLEN || !*last)
+        t->solen_ms = clamp(t->solen_ms + ADAPT_BACKOFF_MS, ADAPT_SOLEN_MIN,
+                            ADAPT_SOLEN_MAX);
+    // The one being shortened has found its limit; with none, start over
+    t->held = *last ? t->held | *last : 0;
+    *last = 0;
+    changed();
+}
+
+uint8_t adapt_result(uint8_t direction, uint8_t gear, uint16_t before,
+                     uint16_t after)
+{
+    uint8_t d = direction != SOLEN_UP;
+    uint8_t result;
+
+    if(before < ADAPT_RPM_MIN || !after)
+        result = ADAPT_UNJUDGED;
+    else if(d == 0)
+        result = (uint32_t)after*100 <= (uint32_t)before*(100-ADAPT_RPM_PCT)
+                 ? ADAPT_GOOD : ADAPT_MISSED;
+    else
+        result = (uint32_t)after*100 >= (uint32_t)before*(100+ADAPT_RPM_PCT)
+                 ? ADAPT_GOOD : ADAPT_MISSED;
+
+    if(result == ADAPT_GOOD)
+    {
+        if(++streak[d][gear-1] >= ADAPT_STREAK)
+        {
+            streak[d][gear-1] = 0;
+            shorten(&adapt.t[d][gear-1], &tried[d][gear-1]);
+        }
+    }else if(result == ADAPT_MISSED)
+    {
+        streak[d][gear-1] = 0;
+        lengthen(&adapt.t[d][gear-1], &tried[d][gear-1]);
+    }
+    BBOX_LOG(BBOX_ADAPT, (uint16_t)gear << 8 | result);
+    return result;
+}
+
+void adapt_save(void)
+{
+    if(!saving)
+    {
+        uint16_t now = millis();
+
+        if(!dirty || (uint16_t)(now - changed_ms) < ADAPT_SAVE_MS)
+            return;
+        adapt.crc = calib_crc_block(&adapt, offsetof(Adapt, crc));
+        dirty = 0;
+        saving = 1;
+    }
+    // The last byte is still being written
+    if(!eeprom_is_ready())
+        return;
+
+    eeprom_update_byte((uint8_t *)ADAPT_EE_ADDR + saving - 1,
+                       ((const uint8_t *)&adapt)[saving - 1]);
+    if(++saving > sizeof(Adapt))
+        saving = 0;
+}
+
+#endif /* ADAPT */
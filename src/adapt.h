@@ -0,0 +1,135 @@
+/** @file
+ * @brief Shift timings learned from the rpm around each shift.
+ *
+ * Every gear and direction has its own ignition cut and solenoid hold,
+ * starting from @c calib.ign_ms and @c calib.solen_ms. The sequencer
+ * reports each shift to adapt_result() with the rpm when the ignition was
+ * cut and once the new gear has had @c calib.settle_ms to engage. An upshift
+ * that went through drops the rpm by the ratio step and a downshift raises
+ * it; one that missed leaves it within #ADAPT_RPM_PCT of where it was.
+ *
+ * After #ADAPT_STREAK good shifts in a row one of the two times is made a
+ * millisecond shorter, taking turns. A miss lengthens the one shortened
+ * last by #ADAPT_BACKOFF_MS and holds it there, as the shortest that shifts
+ * reliably. A miss with nothing being shortened means the box has changed:
+ * both times are lengthened and tried shorter again. The times always stay
+ * within #ADAPT_IGN_MIN to #ADAPT_IGN_MAX and #ADAPT_SOLEN_MIN to
+ * #ADAPT_SOLEN_MAX.
+ *
+ * Shifts below #ADAPT_RPM_MIN are not judged, as the clutch may be
+ * slipping, and neither are shifts with no tach pulse period timed wholly
+ * after the ignition came back, which is always the case with
+ * #TACH_COUNT.
+ *
+ * The table is kept in EEPROM at #ADAPT_EE_ADDR, after the calibration
+ * block, with its own version and CRC. It is discarded at boot if
+ * @c calib.ign_ms or @c calib.solen_ms is not what it was learned from.
+ * Changes are saved once they have stopped for #ADAPT_SAVE_MS, a byte per
+ * adapt_save(), so the main task never waits for an EEPROM write.
+ *
+ * Without #ADAPT every shift uses @c calib.ign_ms and @c calib.solen_ms.
+ *
+ * @date    10/18/2026
+ */
+#ifndef ADAPT_H
+#define ADAPT_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+#define ADAPT_VERSION   1       ///<Bump whenever #Adapt changes
+#define ADAPT_EE_ADDR   0x100   ///<EEPROM address of the block
+
+/** @name Adapt_Timing held bits */
+//@{
+#define ADAPT_HOLD_IGN      0x01    ///<@c ign_ms is not tried shorter
+#define ADAPT_HOLD_SOLEN    0x02    ///<@c solen_ms is not tried shorter
+//@}
+
+/// What adapt_result() made of a shift.
+enum
+{
+    ADAPT_MISSED,       ///< The box stayed in its gear
+    ADAPT_GOOD,         ///< The shift went through
+    ADAPT_UNJUDGED      ///< Too slow or no fresh rpm to tell
+};
+
+/// The times of one gear and direction.
+typedef struct
+{
+    uint8_t ign_ms;     ///< Ignition cut either side of the solenoid (ms)
+    uint8_t solen_ms;   ///< Solenoid on time (ms)
+    uint8_t held;       ///< #ADAPT_HOLD_IGN, #ADAPT_HOLD_SOLEN
+} Adapt_Timing;
+
+/// The learned times, as stored in EEPROM.
+typedef struct
+{
+    uint8_t  version;       ///< #ADAPT_VERSION
+    uint8_t  size;          ///< sizeof(Adapt)
+    uint8_t  base_ign;      ///< @c calib.ign_ms they were learned from
+    uint8_t  base_solen;    ///< @c calib.solen_ms they were learned from
+    Adapt_Timing t[2][MAX_GEARS];   ///< Up, down; by gear shifted out of
+    uint16_t crc;           ///< CRC-16 of every byte before it
+} Adapt;
+
+#ifdef ADAPT
+
+/**
+ * @brief Check the version, size, CRC, base and limits of @c a.
+ *
+ * @return  1 if @c a may be used
+ */
+uint8_t adapt_valid(const Adapt *a);
+
+/**
+ * @brief Load the learned times from EEPROM, or start from the
+ * calibration if the EEPROM copy is not valid. Call after calib_load().
+ *
+ * @return  1 if the EEPROM copy was used
+ */
+uint8_t adapt_load(void);
+
+/**
+ * @brief Start again from @c calib.ign_ms and @c calib.solen_ms.
+ */
+void adapt_reset(void);
+
+/**
+ * @return the ignition cut for a shift in @c direction out of @c gear (ms)
+ */
+uint8_t adapt_ign_ms(uint8_t direction, uint8_t gear);
+
+/**
+ * @return the solenoid hold for a shift in @c direction out of @c gear (ms)
+ */
+uint8_t adapt_solen_ms(uint8_t direction, uint8_t gear);
+
+/**
+ * @brief Judge a finished shift and learn from it.
+ *
+ * @param   direction   #SOLEN_UP or #SOLEN_DN
+ * @param   gear        gear shifted out of
+ * @param   before      rpm when the ignition was cut
+ * @param   after       rpm in the new gear, 0 if there is no fresh sample
+ * @return  #ADAPT_MISSED, #ADAPT_GOOD or #ADAPT_UNJUDGED
+ */
+uint8_t adapt_result(uint8_t direction, uint8_t gear, uint16_t before,
+                     uint16_t after);
+
+/**
+ * @brief Write the next byte of a pending save. Call from the main task
+ * every few ms.
+ */
+void adapt_save(void);
+
+#else
+
+#define adapt_load()            0
+#define adapt_reset()
+#define adapt_ign_ms(d, g)      (calib.ign_ms)
+#define adapt_solen_ms(d, g)    (calib.solen_ms)
+#define adapt_save()
+
+#endif /* ADAPT */
+#endif /* ADAPT_H */
@@ -0,0 +1,160 @@
+/**
+ *  @file
+ *  @brief Timer-triggered ADC acquisition.
+ *
+ *  @date    10/18/2026
+ */
+#include "SAE_AutoShifter.h"
+#include "adc.h"
+#include "prof.h"
+#include "bbox.h"
+#include "config.h"
+
+#define RING_MASK   (ADC_RING_LEN-1)
+
+#if ADC_OVERSAMPLE_BITS > 3
+#error "ADC_OVERSAMPLE_BITS above 3 overflows the 16 bit sums"
+#endif
+#if ADC_THROTTLE_OVERSAMPLE_BITS > ADC_OVERSAMPLE_BITS
+#error "ADC_THROTTLE_OVERSAMPLE_BITS above ADC_OVERSAMPLE_BITS"
+#endif
+
+/// ADMUX channel of each #Adc_Channel
+static const uint8_t mux[ADC_CHANNELS] PROGMEM =
+    {GAS_PEDAL, GEAR_POS_PIN, OIL_TEMP_PIN};
+
+/// Channel converted in each slot of the scan, the throttle every other
+static const uint8_t scan[ADC_SLOTS] PROGMEM =
+    {ADC_THROTTLE, ADC_GEAR_POS, ADC_THROTTLE, ADC_OIL_TEMP};
+
+/// Oversampling bits of each #Adc_Channel
+static const uint8_t bits[ADC_CHANNELS] PROGMEM =
+    {ADC_THROTTLE_OVERSAMPLE_BITS, ADC_OVERSAMPLE_BITS, ADC_OVERSAMPLE_BITS};
+
+/**
+ * Throttle band of each 8 bit throttle value:
+ *  | band | value   |
+ *  |------|---------|
+ *  | 0    | 0-50    |
+ *  | 1    | 51-80   |
+ *  | 2    | 81-114  |
+ *  | 3    | 115-149 |
+ *  | 4    | 150-184 |
+ *  | 5    | 185-255 |
+ */
+static const uint8_t throttle_lut[256] PROGMEM =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5
+};
+
+static uint16_t sum[ADC_CHANNELS];      ///<Samples so far of the next value
+static uint8_t  count[ADC_CHANNELS];    ///<Number of those samples
+static uint8_t  slot;                   ///<Slot of the scan being converted
+static uint16_t ring[ADC_CHANNELS][ADC_RING_LEN];
+static uint8_t  head[ADC_CHANNELS];     ///<Slot of the latest value
+
+void adc_init(void)
+{
+    ADC_DDR &= ~(_BV(GAS_PEDAL)|_BV(GEAR_POS_PIN)|_BV(OIL_TEMP_PIN));
+    DIDR0 |= _BV(GAS_PEDAL)|_BV(GEAR_POS_PIN)|_BV(OIL_TEMP_PIN);
+
+    ADCSRA |= ADC_PS;       //select ADC_PRESCALER
+    ADMUX = _BV(REFS0);     //AVCC reference, right aligned, ADC0
+    ADMUX |= pgm_read_byte(&mux[0]);
+    ADCSRB = (ADCSRB & ~(_BV(ADTS2)|_BV(ADTS1)|_BV(ADTS0)))
+             | _BV(ADTS1)|_BV(ADTS0);   //Trigger on Timer0 compare match A
+    ADCSRA |= _BV(ADATE);   //Auto trigger
+    ADCSRA |= _BV(ADEN);    //Enable ADC
+    ADCSRA |= _BV(ADIE);    //Enable ADC Interrupt
+}
+
+uint16_t adc_value(uint8_t ch)
+{
+    uint16_t v;
+    uint8_t seq;
+
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        v = ring[ch][head[ch]];
+    }while(seqlock_read_retry(&sensor_lock, seq));
+    return v;
+}
+
+uint16_t adc_average(uint8_t ch)
+{
+    uint32_t total;
+    uint8_t seq;
+
+    do
+    {
+        seq = seqlock_read_begin(&sensor_lock);
+        total = 0;
+        for(uint8_t i = 0; i < ADC_RING_LEN; ++i)
+            total += ring[ch][i];
+    }while(seqlock_read_retry(&sensor_lock, seq));
+    return total/ADC_RING_LEN;
+}
+
+/**
+ * @brief Store a decimated value for channel @c ch.
+ */
+static inline void store(uint8_t ch, uint16_t v)
+{
+    uint8_t h = (head[ch] + 1) & RING_MASK;
+
+    seqlock_write_begin(&sensor_lock);
+    ring[ch][h] = v;
+    head[ch] = h;
+
+    if(ch == ADC_THROTTLE)
+    {
+        uint8_t band;
+
+        cur_adc = v >> (ADC_BITS-8);
+        band = pgm_read_byte(&throttle_lut[cur_adc]);
+        if(band != throttle_pos)
+            BBOX_LOG(BBOX_THROTTLE, band);
+        throttle_pos = band;
+    }
+    seqlock_write_end(&sensor_lock);
+}
+
+ISR(ADC_vect)
+{
+    PROF_ISR_BEGIN(PROF_ADC);
+    uint8_t ch = pgm_read_byte(&scan[slot]);
+    uint8_t n = pgm_read_byte(&bits[ch]);
+    uint16_t s = sum[ch] + ADC;
+
+    // Last sample of this channel's value; widen it to ADC_BITS
+    if(++count[ch] == 1 << 2*n)
+    {
+        store(ch, s >> n << (ADC_OVERSAMPLE_BITS - n));
+        count[ch] = 0;
+        s = 0;
+    }
+    sum[ch] = s;
+
+    // Next slot; the mux is only sampled at the next trigger
+    if(++slot == ADC_SLOTS)
+        slot = 0;
+    ADMUX = (ADMUX & 0xF0)
+            | pgm_read_byte(&mux[pgm_read_byte(&scan[slot])]);
+    PROF_ISR_END(PROF_ADC);
+}
@@ -0,0 +1,76 @@
+/** @file
+ * @brief Timer-triggered ADC acquisition.
+ *
+ * Conversions are started by the Timer0 compare match, so there is exactly
+ * one per #TIMER0_FREQ tick and one ISR(ADC_vect) per conversion, instead
+ * of a free-running ADC interrupting every 104 us. The trigger rate is not
+ * configurable: millis() and the timer wheel count the same 1 ms ticks, so
+ * config.h pins #TIMER0_FREQ at 1 kHz, and sharing the tick costs no timer.
+ * The per-channel rates are set by the scan order and the oversampling
+ * instead.
+ *
+ * The scan takes #ADC_SLOTS conversions and gives the throttle every other
+ * one, as shift_task() acts on it; the other channels share the rest. Every
+ * 4^#ADC_THROTTLE_OVERSAMPLE_BITS throttle conversions, or
+ * 4^#ADC_OVERSAMPLE_BITS of another channel, are summed and decimated into
+ * one value, which is pushed into that channel's ring of #ADC_RING_LEN
+ * values. All values are #ADC_BITS wide; a throttle value oversampled less
+ * has its low bits zero. With the defaults the throttle is updated at
+ * #ADC_THROTTLE_RATE_HZ (125 Hz, each value spanning 8 ms) and the gear
+ * position and oil temperature at #ADC_RATE_HZ (15.6 Hz).
+ *
+ * After every new throttle value #cur_adc holds its top 8 bits and
+ * #throttle_pos its band, read from a 256 entry table in flash. Values are
+ * published under #sensor_lock, so adc_value() and adc_average() never
+ * disable interrupts; sensor_snapshot() reads the throttle with the rpm.
+ *
+ * @date    10/18/2026
+ */
+#ifndef ADC_H
+#define ADC_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+/// Scanned channels, in scan order.
+typedef enum
+{
+    ADC_THROTTLE,       ///< Gas pedal, #GAS_PEDAL
+    ADC_GEAR_POS,       ///< Gear position pot, #GEAR_POS_PIN
+    ADC_OIL_TEMP,       ///< Oil temperature sender, #OIL_TEMP_PIN
+    ADC_CHANNELS
+} Adc_Channel;
+
+#define ADC_BITS        (10 + ADC_OVERSAMPLE_BITS)  ///<Bits per value
+#define ADC_SLOTS       (2*(ADC_CHANNELS-1))  ///<Conversions per scan
+///Throttle values per second
+#define ADC_THROTTLE_RATE_HZ \
+    (TIMER0_FREQ/2/(1 << 2*ADC_THROTTLE_OVERSAMPLE_BITS))
+///Values per second of every other channel
+#define ADC_RATE_HZ     (TIMER0_FREQ/ADC_SLOTS/(1 << 2*ADC_OVERSAMPLE_BITS))
+
+/**
+ * @brief Configure the ADC and start the scan. Timer0 provides the trigger.
+ */
+void adc_init(void);
+
+/**
+ * @brief Latest value of channel @c ch, #ADC_BITS wide.
+ */
+uint16_t adc_value(uint8_t ch);
+
+/**
+ * @brief Mean of the last #ADC_RING_LEN values of channel @c ch.
+ */
+uint16_t adc_average(uint8_t ch);
+
+/**
+ * @brief A conversion is complete.
+ *
+ * Fires once per Timer0 tick. Accumulates the sample, selects the next
+ * slot of the scan and, once a channel has all its samples, stores the
+ * decimated value.
+ */
+ISR(ADC_vect);
+
+#endif /* ADC_H */
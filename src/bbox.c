@@ -0,0 +1,140 @@
+/**
+ *  @file
+ *  @brief Black-box event recorder.
+ *
+ *  @date    10/18/2026
+ */
+#include "SAE_AutoShifter.h"
+#include "bbox.h"
+#include "serial.h"
+#include "telemetry.h"
+
+#ifdef BLACKBOX
+
+#define BBOX_MASK   (BBOX_LEN-1)
+#define DUMP_LINE   32          ///<Longest dump line
+#ifdef TELEMETRY
+#define DUMP_ROOM   TLM_FRAME_MAX   ///<Left free for the next frame
+#else
+#define DUMP_ROOM   0
+#endif
+
+static Bbox_Rec ring[BBOX_LEN];
+static uint8_t  head;       ///<Next record to write
+static uint16_t count;      ///<Records held, up to #BBOX_LEN
+static uint8_t  frozen;     ///<Recording stopped
+static uint8_t  stop;       ///<Records left before a pending freeze, 0 if none
+static uint16_t dump;       ///<Records left to dump
+static uint8_t  dump_at;    ///<Next record to dump
+
+static const char name[BBOX_EVENTS][7] PROGMEM =
+    {"paddle", "mode", "req", "phase", "rpm", "tps", "fault", "adapt",
+     "late"};
+
+void bbox_init(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    head = count = 0;
+    frozen = stop = 0;
+    dump = 0;
+    SREG = sreg;
+}
+
+void bbox_log(uint8_t event, uint16_t value)
+{
+    uint8_t sreg = SREG;
+    Bbox_Rec *r;
+
+    cli();
+    if(!frozen)
+    {
+        r = &ring[head];
+        r->ms = sys_ms;
+        r->event = event;
+        r->value = value;
+        head = (head + 1) & BBOX_MASK;
+        if(count < BBOX_LEN)
+            ++count;
+        if(stop && !--stop)
+            frozen = 1;
+    }
+    SREG = sreg;
+}
+
+void bbox_fault(uint8_t fault, uint8_t detail)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    if(!frozen && !stop)
+    {
+        // Counts the fault record itself
+        stop = BBOX_POST_FAULT + 1;
+        bbox_log(BBOX_FAULT, (uint16_t)fault << 8 | detail);
+    }
+    SREG = sreg;
+}
+
+/**
+ * @brief Stop recording now.
+ */
+static void freeze(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    frozen = 1;
+    SREG = sreg;
+}
+
+void bbox_command(int c)
+{
+    char buf[DUMP_LINE+1], id[sizeof(name[0])];
+    const Bbox_Rec *r;
+    uint8_t len;
+
+    switch(c)
+    {
+        case 'f':
+            bbox_log(BBOX_FAULT, (uint16_t)BBOX_FAULT_COMMAND << 8);
+            freeze();
+            break;
+        case 'd':
+            freeze();
+            dump = count;
+            dump_at = (head - count) & BBOX_MASK;
+            break;
+        case 'c':
+            bbox_init();
+            break;
+        default:
+            break;
+    }
+    if(!dump)
+        return;
+
+    // Frozen: the ISRs no longer touch the ring
+    r = &ring[dump_at];
+    memcpy_P(id, name[r->event], sizeof(id));
+    len = serial_fmt_str(buf, 0, "bb ");
+    len = serial_fmt_u(buf, len, r->ms);
+    buf[len++] = ' ';
+    len = serial_fmt_str(buf, len, id);
+    buf[len++] = ' ';
+    len = serial_fmt_u(buf, len, r->value);
+    len = serial_fmt_str(buf, len, "\r\n");
+#ifdef TELEMETRY
+    // Ends a block the decoder drops as bad; the next frame is untouched
+    buf[len++] = TLM_DELIM;
+#endif
+    // Otherwise try again next pass
+    if(serial_write_room(buf, len, DUMP_ROOM))
+    {
+        dump_at = (dump_at + 1) & BBOX_MASK;
+        --dump;
+    }
+}
+
+#endif /* BLACKBOX */
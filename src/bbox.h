@@ -0,0 +1,112 @@
+/** @file
+ * @brief Black-box event recorder.
+ *
+ * A RAM ring of the last #BBOX_LEN events, each stamped with the low 16
+ * bits of #sys_ms: paddle edges, mode changes, shift requests, shift
+ * phases and how they were judged (see adapt.h), rpm samples every
+ * #BBOX_RPM_MS, throttle band changes and missed task deadlines. A #Bbox_Rec is 5 bytes on the
+ * AVR, so the default ring costs 320 bytes of SRAM.
+ *
+ * ISRs and the main task both log with BBOX_LOG(). A record is written
+ * with interrupts disabled for the few cycles it takes; AVR ISRs do not
+ * nest, so there is no lock and nothing ever waits.
+ *
+ * bbox_fault() logs a fault and freezes the ring #BBOX_POST_FAULT records
+ * later, so the events leading up to the fault and just after it are kept.
+ * Serial commands, see bbox_command():
+ *  - @c 'f' records a #BBOX_FAULT_COMMAND fault and freezes the ring
+ *  - @c 'd' freezes it and dumps it, oldest first, one line per main loop
+ *    pass as the transmit buffer has room: "bb <ms> <event> <value>"
+ *  - @c 'c' clears it and starts recording again
+ *
+ * Without #BLACKBOX the macros are empty and nothing is compiled in.
+ *
+ * @date    10/18/2026
+ */
+#ifndef BBOX_H
+#define BBOX_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+/** @name Black Box Defines */
+//@{
+#define BBOX_LEN        64      ///<Records kept (power of 2, at most 256)
+#define BBOX_POST_FAULT (BBOX_LEN/4)    ///<Records kept after a fault
+#define BBOX_RPM_MS     50      ///<Shortest time between rpm records (ms)
+//@}
+
+#if (BBOX_LEN & (BBOX_LEN - 1)) || BBOX_LEN > 256
+#error "BBOX_LEN must be a power of 2 no larger than 256"
+#endif
+
+/// Recorded events, and what their value holds.
+typedef enum
+{
+    BBOX_PADDLE,        ///< #Btn_Event_Type << 8 | pin
+    BBOX_MODE,          ///< New #Mode
+    BBOX_REQUEST,       ///< #SOLEN_UP or #SOLEN_DN << 8 | 1 if accepted
+    BBOX_PHASE,         ///< Gear << 8 | new #Shift_State
+    BBOX_RPM,           ///< Instantaneous rpm
+    BBOX_THROTTLE,      ///< New throttle band
+    BBOX_FAULT,         ///< #Bbox_Fault << 8 | detail
+    BBOX_ADAPT,         ///< Gear << 8 | adapt_result() of a shift out of it
+    BBOX_LATE,          ///< #Task_Id << 8 | ms from release to finish, to 255
+    BBOX_EVENTS
+} Bbox_Event;
+
+/// Faults that freeze the recorder.
+typedef enum
+{
+    BBOX_FAULT_COMMAND,     ///< Frozen from the serial port
+    BBOX_FAULT_STACK        ///< The stack reached the #RAM_GUARD bytes, detail
+                            ///< the first one overwritten
+} Bbox_Fault;
+
+/// One record.
+typedef struct
+{
+    uint16_t ms;        ///< Low bits of #sys_ms
+    uint8_t  event;     ///< #Bbox_Event
+    uint16_t value;     ///< Depends on the event
+} Bbox_Rec;
+
+#ifdef BLACKBOX
+
+/**
+ * @brief Clear the ring and start recording.
+ */
+void bbox_init(void);
+
+/**
+ * @brief Record @c event. Does nothing while frozen.
+ *
+ * Safe from ISRs and the main task.
+ */
+void bbox_log(uint8_t event, uint16_t value);
+
+/**
+ * @brief Record fault @c fault and freeze #BBOX_POST_FAULT records later.
+ *
+ * A fault while one is already pending does not move the freeze.
+ */
+void bbox_fault(uint8_t fault, uint8_t detail);
+
+/**
+ * @brief Handle serial command @c c and send the next line of a dump.
+ *
+ * Call once per main loop pass with the received byte, or -1.
+ */
+void bbox_command(int c);
+
+#define BBOX_LOG(event, value)  bbox_log((event), (value))
+#define BBOX_FAULT(fault, detail)   bbox_fault((fault), (detail))
+
+#else
+
+#define BBOX_LOG(event, value)
+#define BBOX_FAULT(fault, detail)
+
+#endif /* BLACKBOX */
+
+#endif /* BBOX_H */
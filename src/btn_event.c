@@ -0,0 +1,48 @@
+/**
+ *  @file
+ *  @brief Button edge-event queue.
+ *
+ *  @date    10/18/2026
+ */
+#include "hal.h"
+#include "btn_event.h"
+
+#define EVENT_MASK  (BTN_EVENT_QUEUE_LEN-1)
+
+static Btn_Event        events[BTN_EVENT_QUEUE_LEN];
+static volatile uint8_t ev_head;    ///<Written by the debounce
+static volatile uint8_t ev_tail;    ///<Written by the main task
+
+volatile uint8_t btn_event_dropped;
+
+uint8_t btn_event_push(uint8_t type, uint8_t pin, uint16_t ms)
+{
+    uint8_t head = ev_head;
+    uint8_t next = (head + 1) & EVENT_MASK;
+
+    if(next == ev_tail)
+    {
+        ++btn_event_dropped;
+        return 0;
+    }
+    events[head].type = type;
+    events[head].pin = pin;
+    events[head].ms = ms;
+    // Publish only once the slot is filled in
+    HAL_BARRIER();
+    ev_head = next;
+    return 1;
+}
+
+uint8_t btn_event_pop(Btn_Event *ev)
+{
+    uint8_t tail = ev_tail;
+
+    if(tail == ev_head)
+        return 0;
+    HAL_BARRIER();
+    *ev = events[tail];
+    HAL_BARRIER();
+    ev_tail = (tail + 1) & EVENT_MASK;
+    return 1;
+}
@@ -0,0 +1,52 @@
+/** @file
+ * @brief Button edge-event queue.
+ *
+ * The debounce, a 1 ms timer on the wheel in timer.h, turns paddle
+ * activity into timestamped press, release and long-press events. They are
+ * passed to #TASK_PADDLE through a single-producer/single-consumer ring:
+ * only the debounce advances the head and only the task advances the
+ * tail, so neither side disables interrupts.
+ *
+ * @date    10/18/2026
+ */
+#ifndef BTN_EVENT_H
+#define BTN_EVENT_H 1
+
+#include <stdint.h>
+
+#define BTN_EVENT_QUEUE_LEN 8   ///<Queue length (power of 2, at most 256)
+
+/// What happened to the button.
+typedef enum
+{
+    BTN_PRESS,          ///< Debounced press
+    BTN_RELEASE,        ///< Release after a press
+    BTN_LONG_PRESS      ///< Still pressed after #BTN_LONG_PRESS_MS
+} Btn_Event_Type;
+
+/// One button event.
+typedef struct
+{
+    uint8_t  type;      ///< #Btn_Event_Type
+    uint8_t  pin;       ///< Button pin, e.g. #USHIFT_PIN
+    uint16_t ms;        ///< Time of the event, low bits of #sys_ms
+} Btn_Event;
+
+extern volatile uint8_t btn_event_dropped; ///<Events lost to a full queue
+
+/**
+ * @brief Queue an event. From the debounce only.
+ *
+ * @return 1 if queued, 0 if the queue was full
+ */
+uint8_t btn_event_push(uint8_t type, uint8_t pin, uint16_t ms);
+
+/**
+ * @brief Take the oldest event. Main context only.
+ *
+ * @param   ev  where to store the event
+ * @return  1 if an event was taken, 0 if the queue was empty
+ */
+uint8_t btn_event_pop(Btn_Event *ev);
+
+#endif /* BTN_EVENT_H */
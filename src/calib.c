@@ -0,0 +1,135 @@
+/**
+ *  @file
+ *  @brief Calibration block kept in EEPROM.
+ *
+ *  @date    10/18/2026
+ */
+#include <stddef.h>
+#include <string.h>
+#define SHIFTMAP_TABLES     // The default tables live here
+#include "calib.h"
+#include "config.h"
+
+/// The size field is a byte
+typedef char calib_size_check[sizeof(Calib) <= 0xFF ? 1 : -1];
+/// Host tools write images for the AVR, which packs structures: no padding
+typedef char calib_pad_check[
+    offsetof(Calib, up_trim) == offsetof(Calib, tps) + SHIFTMAP_POINTS &&
+    sizeof(Calib) == offsetof(Calib, crc) + sizeof(uint16_t) ? 1 : -1];
+
+Calib calib;
+
+void calib_defaults(Calib *c)
+{
+    c->version   = CALIB_VERSION;
+    c->size      = sizeof(Calib);
+    c->ign_ms    = IGNITION_DLY;
+    c->solen_ms  = SOLEN_DLY;
+    c->settle_ms = SHIFT_SETTLE_DLY;
+    c->db_ms     = DB_DELAY;
+    c->pulse_rot = PULSE_ROT;
+    c->engage_ms = SHIFT_ENGAGE_DLY;
+    memset(c->lead_pct, SHIFT_LEAD_PCT, sizeof(c->lead_pct));
+    memcpy_P(c->tps, shiftmap_tps, sizeof(c->tps));
+    memset(c->up_trim, 0, sizeof(c->up_trim));
+    memset(c->down_trim, 0, sizeof(c->down_trim));
+    c->lead_max  = SHIFT_LEAD_MAX;
+    c->crc = calib_crc(c);
+}
+
+uint16_t calib_crc_block(const void *p, uint8_t n)
+{
+    const uint8_t *b = p;
+    uint16_t crc = 0xFFFF;
+
+    for(uint8_t i = 0; i < n; ++i)
+    {
+        crc ^= (uint16_t)b[i] << 8;
+        for(uint8_t bit = 0; bit < 8; ++bit)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+uint16_t calib_crc(const Calib *c)
+{
+    return calib_crc_block(c, offsetof(Calib, crc));
+}
+
+/**
+ * @brief Cell @c n of a flash table, counted across the rows, plus its
+ * trim. May be negative or too high until calib_map_valid() has passed.
+ */
+static int32_t cell(const Calib *c, uint8_t up, uint8_t n)
+{
+    const uint16_t *map = up ? shiftmap_up_rpm[0] : shiftmap_down_rpm[0];
+    const int8_t *trim = up ? c->up_trim[0] : c->down_trim[0];
+
+    return pgm_read_word(&map[n]) + (int32_t)trim[n]*CALIB_TRIM_RPM;
+}
+
+uint16_t calib_cell(const Calib *c, uint8_t up, uint8_t gear, uint8_t point)
+{
+    return cell(c, up, (gear-1)*SHIFTMAP_POINTS + point);
+}
+
+uint8_t calib_trim(Calib *c, uint8_t up, uint8_t gear, uint8_t point,
+                   uint16_t rpm)
+{
+    uint8_t n = (gear-1)*SHIFTMAP_POINTS + point;
+    int8_t *trim = &(up ? c->up_trim[0] : c->down_trim[0])[n];
+    int32_t d = (int32_t)rpm - cell(c, up, n) + *trim*CALIB_TRIM_RPM;
+
+    // Steps from the flash map, to the nearest
+    d = (d + (d < 0 ? -CALIB_TRIM_RPM/2 : CALIB_TRIM_RPM/2))/CALIB_TRIM_RPM;
+    if(d < INT8_MIN || d > INT8_MAX)
+        return 0;
+    *trim = d;
+    return 1;
+}
+
+uint8_t calib_map_valid(const Calib *c)
+{
+    for(uint8_t i = 1; i < SHIFTMAP_POINTS; ++i)
+        if(c->tps[i] <= c->tps[i-1])
+            return 0;
+    for(uint8_t n = 0; n < SHIFTMAP_GEARS*SHIFTMAP_POINTS; ++n)
+    {
+        int32_t up = cell(c, 1, n), down = cell(c, 0, n);
+
+        // As shiftmap_gen checks the CSV, and room for the lead
+        if(down < 0 || up > TACH_RPM_LIMIT || down >= up ||
+           c->lead_max >= up - down)
+            return 0;
+        if(n % SHIFTMAP_POINTS &&
+           (up < cell(c, 1, n-1) || down < cell(c, 0, n-1)))
+            return 0;
+    }
+    return 1;
+}
+
+uint8_t calib_valid(const Calib *c)
+{
+    if(c->version != CALIB_VERSION || c->size != sizeof(Calib) ||
+       c->crc != calib_crc(c))
+        return 0;
+
+    // Zero would stall the sequencer or divide by zero
+    if(!c->ign_ms || !c->solen_ms || !c->settle_ms || !c->db_ms ||
+       !c->pulse_rot)
+        return 0;
+    for(uint8_t i = 0; i < SHIFTMAP_GEARS; ++i)
+        if(c->lead_pct[i] > SHIFT_LEAD_PCT_MAX)
+            return 0;
+    return calib_map_valid(c);
+}
+
+uint8_t calib_load(void)
+{
+    eeprom_read_block(&calib, (const void *)CALIB_EE_ADDR, sizeof(Calib));
+    if(calib_valid(&calib))
+        return 1;
+
+    calib_defaults(&calib);
+    return 0;
+}
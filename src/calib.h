@@ -0,0 +1,120 @@
+/** @file
+ * @brief Calibration block kept in EEPROM.
+ *
+ * The shift map trims, the shift timings and the upshift prediction are
+ * loaded into #calib once at boot by calib_load(). The block carries a
+ * layout version, its size and a CRC-16; if any of them do not match, or a
+ * value is out of range, the compiled-in defaults are used instead: no
+ * trims and the timing defines in defines.h. Either way the rest of the
+ * firmware reads only #calib.
+ *
+ * The shift map itself stays in flash, see shiftmap.h. The block holds its
+ * throttle breakpoints and a signed trim per cell in #CALIB_TRIM_RPM steps,
+ * so the map costs a byte of RAM per cell instead of two, and
+ * calib_cell() reads a cell with its trim applied.
+ *
+ * EEPROM images are written by tools/calib_gen.c, which shares this file
+ * with the firmware, so a new calibration can be loaded with avrdude
+ * without reflashing the program.
+ *
+ * @date    10/18/2026
+ */
+#ifndef CALIB_H
+#define CALIB_H 1
+
+#include <stdint.h>
+#include "defines.h"
+#include "shiftmap_table.h"
+
+#define CALIB_VERSION   3       ///<Bump whenever #Calib changes
+#define CALIB_EE_ADDR   0x000   ///<EEPROM address of the block
+#define CALIB_TRIM_RPM  50      ///<Rpm per step of a shift map trim
+
+/// The calibration block, as stored in EEPROM.
+typedef struct
+{
+    uint8_t  version;       ///< #CALIB_VERSION
+    uint8_t  size;          ///< sizeof(Calib)
+    uint8_t  ign_ms;        ///< Ignition cut either side of the solenoid (ms)
+    uint8_t  solen_ms;      ///< Solenoid on time (ms)
+    uint8_t  settle_ms;     ///< Hold off between shifts (ms)
+    uint8_t  db_ms;         ///< Button debounce (ms)
+    uint8_t  pulse_rot;     ///< Tachometer pulses per rotation
+    uint8_t  engage_ms;     ///< Solenoid release to gear engaged (ms)
+    uint8_t  lead_pct[SHIFTMAP_GEARS];  ///< Upshift lead per gear (%)
+    uint8_t  tps[SHIFTMAP_POINTS];                       ///< Throttle points
+    int8_t   up_trim[SHIFTMAP_GEARS][SHIFTMAP_POINTS];   ///< Upshift trims
+    int8_t   down_trim[SHIFTMAP_GEARS][SHIFTMAP_POINTS]; ///< Downshift trims
+    uint16_t lead_max;      ///< Most an upshift may be started early (rpm)
+    uint16_t crc;           ///< CRC-16 of every byte before it
+} Calib;
+
+extern Calib calib;     ///<Calibration in use
+
+/**
+ * @brief Fill @c c with the compiled-in defaults and a valid CRC.
+ */
+void calib_defaults(Calib *c);
+
+/**
+ * @brief CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of @c n
+ * bytes at @c p.
+ */
+uint16_t calib_crc_block(const void *p, uint8_t n);
+
+/**
+ * @brief calib_crc_block() of the block up to its @c crc field.
+ */
+uint16_t calib_crc(const Calib *c);
+
+/**
+ * @brief Rpm of a shift map cell: the flash map plus its trim in @c c.
+ *
+ * @param   c       calibration holding the trim
+ * @param   up      1 for the upshift map, 0 for the downshift map
+ * @param   gear    gear number, 1 to #SHIFTMAP_GEARS
+ * @param   point   throttle breakpoint, 0 to #SHIFTMAP_POINTS-1
+ */
+uint16_t calib_cell(const Calib *c, uint8_t up, uint8_t gear, uint8_t point);
+
+/**
+ * @brief Trim a shift map cell of @c c to the step nearest @c rpm.
+ *
+ * Parameters as calib_cell(). Only the trim is checked; the map as a whole
+ * is left to calib_map_valid().
+ *
+ * @return  1 if done, 0 if @c rpm is beyond the reach of a trim
+ */
+uint8_t calib_trim(Calib *c, uint8_t up, uint8_t gear, uint8_t point,
+                   uint16_t rpm);
+
+/**
+ * @brief Check the shift map of @c c.
+ *
+ * The rules shiftmap_gen applies to the CSV: increasing throttle
+ * breakpoints, every downshift rpm below its upshift rpm, neither falling
+ * as the throttle opens, and no upshift above #TACH_RPM_LIMIT. On top of
+ * them @c lead_max must be below every gap between the two, so a lead
+ * cannot reach the downshift point.
+ *
+ * @return  1 if the map may be used
+ */
+uint8_t calib_map_valid(const Calib *c);
+
+/**
+ * @brief Check the version, size, CRC and value ranges of @c c, its shift
+ * map included, see calib_map_valid().
+ *
+ * @return  1 if @c c may be used
+ */
+uint8_t calib_valid(const Calib *c);
+
+/**
+ * @brief Load #calib from EEPROM, or from the defaults if the EEPROM copy
+ * is not valid. Call once at boot, before interrupts are enabled.
+ *
+ * @return  1 if the EEPROM copy was used
+ */
+uint8_t calib_load(void);
+
+#endif /* CALIB_H */
@@ -0,0 +1,391 @@
+/**
+ *  @file
+ *  @brief Serial command line for live tuning and queries.
+ *
+ *  @date    10/18/2026
+ */
+#include <stddef.h>
+#include <string.h>
+#include "SAE_AutoShifter.h"
+#include "cmd.h"
+#include "calib.h"
+#include "serial.h"
+#include "telemetry.h"
+#include "sched.h"
+#include "shift.h"
+#include "btn_event.h"
+#include "adapt.h"
+
+#define REPLY_LEN   40      ///<Longest reply line
+#define WORDS       5       ///<Most words in a line
+#define STARTS      "gs"    ///<First letters of the command words
+#ifdef TELEMETRY
+#define REPLY_ROOM  TLM_FRAME_MAX   ///<Left free for the next frame
+#else
+#define REPLY_ROOM  0
+#endif
+
+/// How a #Param is indexed.
+enum
+{
+    BY_NONE,            ///< A single value
+    BY_GEAR,            ///< One per gear
+    BY_POINT,           ///< One per throttle breakpoint
+    BY_GEAR_POINT       ///< A shift map trim per gear and breakpoint, as rpm
+};
+
+/// A value of #calib that can be tuned.
+typedef struct
+{
+    char     name[8];
+    uint8_t  offset;    ///< offsetof() its first element in #Calib
+    uint8_t  index;     ///< BY_NONE ...
+    uint8_t  wide;      ///< uint16_t, else uint8_t
+    uint16_t min;       ///< Smallest value set may store
+    uint16_t max;       ///< Largest
+} Param;
+
+static const Param params[] PROGMEM =
+{
+    {"ign",     offsetof(Calib, ign_ms),    BY_NONE,  0, 1, 255},
+    {"solen",   offsetof(Calib, solen_ms),  BY_NONE,  0, 1, 255},
+    {"settle",  offsetof(Calib, settle_ms), BY_NONE,  0, 1, 255},
+    {"engage",  offsetof(Calib, engage_ms), BY_NONE,  0, 0, 255},
+    {"db",      offsetof(Calib, db_ms),     BY_NONE,  0, 1, 255},
+    {"leadmax", offsetof(Calib, lead_max),  BY_NONE,  1, 0, TACH_RPM_LIMIT},
+    {"lead",    offsetof(Calib, lead_pct),  BY_GEAR,  0, 0, SHIFT_LEAD_PCT_MAX},
+    {"tps",     offsetof(Calib, tps),       BY_POINT, 0, 0, 255},
+    {"up",   offsetof(Calib, up_trim),   BY_GEAR_POINT, 0, 0, TACH_RPM_LIMIT},
+    {"down", offsetof(Calib, down_trim), BY_GEAR_POINT, 0, 0, TACH_RPM_LIMIT},
+};
+
+#define PARAMS  (sizeof(params)/sizeof(params[0]))
+
+/// Longest reply: a name as long as a line, a space, 5 digits and CR LF
+typedef char reply_check[CMD_LINE_LEN + 8 <= REPLY_LEN ? 1 : -1];
+
+static char    line[CMD_LINE_LEN];  ///<Line being received
+static uint8_t len;                 ///<Its length
+static uint8_t overflow;            ///<It was too long
+static char    reply[REPLY_LEN+1];  ///<Reply waiting for room
+static uint8_t reply_len;           ///<Its length, 0 when none
+static uint8_t stat_line;           ///<Next stat line, 0 when idle
+
+/**
+ * @brief Split @c s into words at spaces.
+ *
+ * @return the number of words, more than #WORDS if they did not all fit
+ */
+static uint8_t split(char *s, char *word[WORDS])
+{
+    uint8_t n = 0;
+
+    for(;;)
+    {
+        while(*s == ' ')
+            *s++ = 0;
+        if(!*s)
+            return n;
+        if(n == WORDS)
+            return n + 1;
+        word[n++] = s;
+        while(*s && *s != ' ')
+            ++s;
+    }
+}
+
+/**
+ * @brief Parse the decimal number @c s into @c v.
+ *
+ * @return 1 if it is one and fits 16 bits
+ */
+static uint8_t number(const char *s, uint16_t *v)
+{
+    uint32_t n = 0;
+
+    if(!*s)
+        return 0;
+    for(; *s; ++s)
+    {
+        if(*s < '0' || *s > '9')
+            return 0;
+        n = n*10 + (*s - '0');
+        if(n > UINT16_MAX)
+            return 0;
+    }
+    *v = n;
+    return 1;
+}
+
+/**
+ * @brief Find the element of @c p the @c n indices @c ix select.
+ *
+ * @return its address in #calib, 0 if the indices do not fit @c p
+ */
+static uint8_t *element(const Param *p, const uint16_t *ix, uint8_t n)
+{
+    uint8_t i;
+
+    switch(p->index)
+    {
+        case BY_NONE:
+            if(n != 0)
+                return 0;
+            i = 0;
+            break;
+        case BY_GEAR:
+            if(n != 1 || ix[0] < 1 || ix[0] > SHIFTMAP_GEARS)
+                return 0;
+            i = ix[0] - 1;
+            break;
+        case BY_POINT:
+            if(n != 1 || ix[0] >= SHIFTMAP_POINTS)
+                return 0;
+            i = ix[0];
+            break;
+        default:
+            if(n != 2 || ix[0] < 1 || ix[0] > SHIFTMAP_GEARS ||
+               ix[1] >= SHIFTMAP_POINTS)
+                return 0;
+            i = (ix[0] - 1)*SHIFTMAP_POINTS + ix[1];
+            break;
+    }
+    return (uint8_t *)&calib + p->offset + (i << p->wide);
+}
+
+/**
+ * @brief Get or set the #calib value @c name.
+ *
+ * @return 1 if done, with the value in @c v
+ */
+static uint8_t tune(const char *name, const uint16_t *ix, uint8_t n,
+                    uint8_t set, uint16_t *v)
+{
+    Param p;
+    uint8_t *e = 0;
+    uint8_t up;
+
+    for(uint8_t i = 0; i < PARAMS && !e; ++i)
+    {
+        memcpy_P(&p, &params[i], sizeof(p));
+        if(!strcmp(name, p.name) && !(e = element(&p, ix, n)))
+            return 0;
+    }
+    if(!e)
+        return 0;
+    up = p.offset == offsetof(Calib, up_trim);
+
+    if(set)
+    {
+        if(*v < p.min || *v > p.max)
+            return 0;
+        if(p.offset == offsetof(Calib, db_ms))
+            btn_debounce(*v);
+        else
+        {
+            uint16_t old = p.wide ? *(uint16_t *)e : *e;
+
+            if(p.index == BY_GEAR_POINT)
+            {
+                if(!calib_trim(&calib, up, ix[0], ix[1], *v))
+                    return 0;
+            }else if(p.wide)
+                *(uint16_t *)e = *v;
+            else
+                *e = *v;
+            // The shift map follows the same rules as an EEPROM block
+            if(!calib_map_valid(&calib))
+            {
+                if(p.wide)
+                    *(uint16_t *)e = old;
+                else
+                    *e = old;
+                return 0;
+            }
+        }
+        // The learned times start over from the new ones
+        if(p.offset == offsetof(Calib, ign_ms) ||
+           p.offset == offsetof(Calib, solen_ms))
+            adapt_reset();
+    }
+    if(p.index == BY_GEAR_POINT)
+        *v = calib_cell(&calib, up, ix[0], ix[1]);
+    else
+        *v = p.wide ? *(uint16_t *)e : *e;
+    return 1;
+}
+
+/**
+ * @brief Run the line in #line and leave its reply in #reply.
+ */
+static void run(void)
+{
+    char *word[WORDS];
+    uint16_t v[WORDS];
+    uint8_t n, set, ok = 0;
+
+    // Refused unless it turns out otherwise, while the line is intact
+    reply_len = serial_fmt_str(reply, 0, "? ");
+    reply_len = serial_fmt_str(reply, reply_len, line);
+    reply_len = serial_fmt_str(reply, reply_len, "\r\n");
+    n = split(line, word);
+    if(overflow || n > WORDS)
+        ;
+    else if(n == 1 && !strcmp(word[0], "stat"))
+    {
+        stat_line = 1;
+        reply_len = 0;
+        return;
+    }else if(n >= 2 && ((set = !strcmp(word[0], "set")) ||
+                        !strcmp(word[0], "get")))
+    {
+        // Indices, then the value for set
+        ok = n - 2 >= set;
+        for(uint8_t i = 2; i < n && ok; ++i)
+            ok = number(word[i], &v[i-2]);
+        n -= 2 + set;
+        if(!ok)
+            ;
+        else if(!strcmp(word[1], "tlm"))
+        {
+            if((ok = !n && (!set || v[0] >= CMD_TLM_MIN_MS)))
+            {
+                if(set)
+                    sched_period(TASK_OUTPUT, v[0]);
+                v[0] = sched_tasks[TASK_OUTPUT].period;
+            }
+        }else if(!strcmp(word[1], "mode"))
+        {
+            if((ok = !n && (!set || v[0] <= MODE_SWITCH)))
+            {
+                if(set)
+                    mode_force(v[0]);
+                v[0] = mode;
+            }
+        }else
+        {
+            // The value is the last number, after the indices
+            uint16_t value = set ? v[n] : 0;
+
+            ok = tune(word[1], v, n, set, &value);
+            v[0] = value;
+        }
+    }
+    if(ok)
+    {
+        reply_len = serial_fmt_str(reply, 0, word[1]);
+        reply[reply_len++] = ' ';
+        reply_len = serial_fmt_u(reply, reply_len, v[0]);
+        reply_len = serial_fmt_str(reply, reply_len, "\r\n");
+    }
+}
+
+/**
+ * @brief Format stat line @c n into @c buf.
+ *
+ * @return its length, 0 past the last line
+ */
+static uint8_t stat(uint8_t n, char *buf)
+{
+    uint8_t sreg = SREG;
+    uint16_t rx;
+    uint8_t len = 0;
+
+    switch(n)
+    {
+        case 1:
+            len = serial_fmt_str(buf, 0, "late");
+            for(uint8_t i = 0; i < TASKS; ++i)
+            {
+                buf[len++] = ' ';
+                len = serial_fmt_u(buf, len, sched_tasks[i].missed);
+            }
+            break;
+        case 2:
+            cli();
+            rx = serial_rx_dropped;
+            SREG = sreg;
+            len = serial_fmt_str(buf, 0, "drop tx ");
+            len = serial_fmt_u(buf, len, serial_tx_dropped);
+            len = serial_fmt_str(buf, len, " rx ");
+            len = serial_fmt_u(buf, len, rx);
+            len = serial_fmt_str(buf, len, " btn ");
+            len = serial_fmt_u(buf, len, btn_event_dropped);
+            break;
+        case 3:
+            len = serial_fmt_str(buf, 0, "tach glitch ");
+            len = serial_fmt_u(buf, len, tach.glitches);
+            len = serial_fmt_str(buf, len, " latency ");
+            len = serial_fmt_u(buf, len, shift_latency());
+            break;
+        default:
+            return 0;
+    }
+    return serial_fmt_str(buf, len, "\r\n");
+}
+
+/**
+ * @brief Send @c len bytes of @c buf as one reply line.
+ *
+ * @return 1 if sent, 0 if there was no room yet
+ */
+static uint8_t send(char *buf, uint8_t len)
+{
+#ifdef TELEMETRY
+    // Ends a block the decoder drops as bad; the next frame is untouched
+    buf[len++] = TLM_DELIM;
+#endif
+    return serial_write_room(buf, len, REPLY_ROOM) != 0;
+}
+
+int cmd_poll(void)
+{
+    // Replies go out before any more input is taken
+    if(reply_len)
+    {
+        if(!send(reply, reply_len))
+            return -1;
+        reply_len = 0;
+    }
+    if(stat_line)
+    {
+        char buf[REPLY_LEN+1];
+        uint8_t n = stat(stat_line, buf);
+
+        if(!n)
+            stat_line = 0;
+        else if(send(buf, n))
+            ++stat_line;
+        return -1;
+    }
+
+    for(uint8_t i = 0; i < CMD_POLL_BYTES; ++i)
+    {
+        int c = serial_getc();
+
+        if(c < 0)
+            break;
+        if(c == CR || c == LF || c == ';')
+        {
+            if(!len)
+                continue;
+            // One line per pass
+            line[len] = 0;
+            run();
+            len = 0;
+            overflow = 0;
+            break;
+        }
+        if(!len && (!c || !strchr(STARTS, c)))
+        {
+            if(c != ' ')
+                return c;
+            continue;
+        }
+        if(len < CMD_LINE_LEN-1)
+            line[len++] = c;
+        else
+            overflow = 1;
+    }
+    return -1;
+}
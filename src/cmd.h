@@ -0,0 +1,70 @@
+/** @file
+ * @brief Serial command line for live tuning and queries.
+ *
+ * cmd_poll() runs every #TASK_HOUSEKEEPING pass, takes at most
+ * #CMD_POLL_BYTES bytes from the receive buffer and runs at most one line,
+ * so a burst of input is spread over several passes; the rest waits in the
+ * buffer. Bytes gather into a line, which runs once CR, LF or ';' ends it:
+ *  - <tt>get <name> [index...]</tt> replies "<name> <value>"
+ *  - <tt>set <name> [index...] <value></tt> replies as get, with the new
+ *    value, or "? <line>" if the name, an index or the value is refused
+ *  - <tt>stat</tt> sends the counters, one line per pass as the transmit
+ *    buffer has room: "late <missed deadlines of each task>",
+ *    "drop tx <n> rx <n> btn <n>" and "tach glitch <n> latency <ms>"
+ *
+ *  | name    | index         | value                                    |
+ *  |---------|---------------|------------------------------------------|
+ *  | ign     |               | @c calib.ign_ms, 1-255                   |
+ *  | solen   |               | @c calib.solen_ms, 1-255                 |
+ *  | settle  |               | @c calib.settle_ms, 1-255                |
+ *  | engage  |               | @c calib.engage_ms, 0-255                |
+ *  | db      |               | @c calib.db_ms, 1-255, see btn_debounce() |
+ *  | leadmax |               | @c calib.lead_max, rpm, below up - down  |
+ *  | lead    | gear          | @c calib.lead_pct, 0-#SHIFT_LEAD_PCT_MAX |
+ *  | tps     | point         | throttle breakpoint, kept increasing     |
+ *  | up      | gear point    | upshift rpm                              |
+ *  | down    | gear point    | downshift rpm, below up                  |
+ *  | tlm     |               | #TASK_OUTPUT period (ms)                 |
+ *  | mode    |               | #Mode, or #MODE_SWITCH, see mode_force() |
+ *
+ * Gears count from 1 and points from 0. Rpm are at most #TACH_RPM_LIMIT.
+ * A value that would break the rules of calib_map_valid() is refused: the
+ * up and down rpm of a gear may not fall as the throttle opens, and
+ * leadmax must stay below every gap between them. Up and down are kept
+ * as a trim of the flash map, see calib_cell(), so they are rounded to
+ * #CALIB_TRIM_RPM and reach at most 127 steps either side of it; get
+ * replies with the rpm in use.
+ * Changes are made to #calib in RAM and last until reset. Setting ign or
+ * solen also starts the learned shift timings over from them, see adapt.h.
+ *
+ * A byte that starts a line and is not the first letter of one of these is
+ * a one-key command. cmd_poll() returns it for prof_command(),
+ * bbox_command() and ram_command().
+ *
+ * With #TELEMETRY every reply line ends in the frame delimiter, so the
+ * decoder drops it as one bad block, and is held back until a frame still
+ * fits behind it. Replies are formatted without stdio, see
+ * serial_fmt_u().
+ *
+ * @date    10/18/2026
+ */
+#ifndef CMD_H
+#define CMD_H 1
+
+#include <stdint.h>
+
+/** @name Command Defines */
+//@{
+#define CMD_LINE_LEN    32  ///<Longest command line
+#define CMD_POLL_BYTES  16  ///<Bytes taken per cmd_poll()
+#define CMD_TLM_MIN_MS  5   ///<Shortest #TASK_OUTPUT period allowed (ms)
+//@}
+
+/**
+ * @brief Take the received bytes, run a complete line and send replies.
+ *
+ * @return a one-key command, or -1 if there is none
+ */
+int cmd_poll(void);
+
+#endif /* CMD_H */
@@ -0,0 +1,145 @@
+/** @file
+ * @brief Register values derived from defines.h, checked at compile time.
+ *
+ * The settings in defines.h are plain numbers; this file turns them into
+ * the values the peripherals are loaded with and refuses to build if one
+ * does not fit its register or does not divide out exactly. Everything here
+ * is resolved by the preprocessor, so no code runs at boot to work it out
+ * and a bad setting is caught before it reaches the board. The shift map is
+ * checked by shiftmap_gen when its tables are generated.
+ *
+ * @date    10/18/2026
+ */
+#ifndef CONFIG_H
+#define CONFIG_H 1
+
+#include "defines.h"
+#include "serial.h"
+#include "shiftmap_table.h"
+
+/** @name Timer0 */
+//@{
+/// Timer0 counts per second
+#define TIMER0_CLOCK    (F_CPU/PRESCALER0)
+/// OCR0A for a #TIMER0_FREQ compare match in CTC mode
+#define TIMER0_OCR      (TIMER0_CLOCK/TIMER0_FREQ-1)
+
+#if PRESCALER0 == 1
+#define TIMER0_CS       (_BV(CS00))
+#elif PRESCALER0 == 8
+#define TIMER0_CS       (_BV(CS01))
+#elif PRESCALER0 == 64
+#define TIMER0_CS       (_BV(CS01)|_BV(CS00))
+#elif PRESCALER0 == 256
+#define TIMER0_CS       (_BV(CS02))
+#elif PRESCALER0 == 1024
+#define TIMER0_CS       (_BV(CS02)|_BV(CS00))
+#else
+#error "PRESCALER0 must be 1, 8, 64, 256 or 1024"
+#endif
+
+#if F_CPU % PRESCALER0 || TIMER0_CLOCK % TIMER0_FREQ
+#error "TIMER0_FREQ does not divide the Timer0 clock exactly"
+#endif
+#if TIMER0_OCR < 1 || TIMER0_OCR > 0xFF
+#error "TIMER0_FREQ needs an OCR0A outside 1-255, change PRESCALER0"
+#endif
+#if 1000000UL % TIMER0_CLOCK
+#error "micros() needs a whole number of us per Timer0 count"
+#endif
+#if TIMER0_FREQ != 1000
+#error "millis() and the timer wheel count a 1 ms tick"
+#endif
+//@}
+
+/** @name ADC */
+//@{
+/// ADC conversion clock (Hz)
+#define ADC_CLOCK       (F_CPU/ADC_PRESCALER)
+
+#if ADC_PRESCALER == 2
+#define ADC_PS          (_BV(ADPS0))
+#elif ADC_PRESCALER == 4
+#define ADC_PS          (_BV(ADPS1))
+#elif ADC_PRESCALER == 8
+#define ADC_PS          (_BV(ADPS1)|_BV(ADPS0))
+#elif ADC_PRESCALER == 16
+#define ADC_PS          (_BV(ADPS2))
+#elif ADC_PRESCALER == 32
+#define ADC_PS          (_BV(ADPS2)|_BV(ADPS0))
+#elif ADC_PRESCALER == 64
+#define ADC_PS          (_BV(ADPS2)|_BV(ADPS1))
+#elif ADC_PRESCALER == 128
+#define ADC_PS          (_BV(ADPS2)|_BV(ADPS1)|_BV(ADPS0))
+#else
+#error "ADC_PRESCALER must be a power of 2 from 2 to 128"
+#endif
+
+#if ADC_CLOCK < 50000 || ADC_CLOCK > 200000
+#error "ADC_PRESCALER puts the ADC clock outside 50-200 kHz"
+#endif
+// One conversion takes 13 ADC clocks and must end before the next trigger
+#if ADC_CLOCK/13 < TIMER0_FREQ
+#error "ADC conversions are slower than the Timer0 trigger"
+#endif
+//@}
+
+/** @name USART */
+//@{
+#if (SERIAL_BAUD & (USART_2X-1)) > 0x0FFF
+#error "SERIAL_BAUD does not fit the 12 bit UBRR0"
+#endif
+//@}
+
+/** @name Watchdog */
+//@{
+/// Nominal watchdog timeout (ms); the oscillator is only good to 10% or so
+#define WDT_TIMEOUT_MS  (16 << WDT_TIMEOUT)
+
+#if WDT_TIMEOUT < WDTO_15MS || WDT_TIMEOUT > WDTO_2S
+#error "WDT_TIMEOUT must be one of the WDTO_ values"
+#endif
+#if 2*WDT_KICK_MS > WDT_TIMEOUT_MS
+#error "WDT_KICK_MS leaves no margin before the watchdog bites"
+#endif
+//@}
+
+/** @name Gearbox */
+//@{
+#if MAX_GEARS < 2 || MAX_GEARS > 15
+#error "MAX_GEARS must be 2-15, gears are a nibble of telemetry"
+#endif
+#if SHIFTMAP_GEARS != MAX_GEARS
+#error "calib/shiftmap.csv does not match MAX_GEARS"
+#endif
+#if SHIFTMAP_RPM_MAX > TACH_RPM_LIMIT
+#error "calib/shiftmap.csv shifts above TACH_RPM_LIMIT"
+#endif
+#if RPM_MAX >= TACH_RPM_LIMIT
+#error "RPM_MAX must be below TACH_RPM_LIMIT"
+#endif
+#if RPM_HIST_LEN > 255
+#error "RPM_HIST_LEN must fit the 8 bit history index"
+#endif
+//@}
+
+#ifdef ADAPT
+/** @name Adaptive Timing */
+//@{
+#if ADAPT_IGN_MIN < 1 || ADAPT_IGN_MIN > ADAPT_IGN_MAX || ADAPT_IGN_MAX > 0xFF
+#error "ADAPT_IGN_MIN and ADAPT_IGN_MAX must be ordered, 1-255"
+#endif
+#if ADAPT_SOLEN_MIN < 1 || ADAPT_SOLEN_MIN > ADAPT_SOLEN_MAX || \
+    ADAPT_SOLEN_MAX > 0xFF
+#error "ADAPT_SOLEN_MIN and ADAPT_SOLEN_MAX must be ordered, 1-255"
+#endif
+#if ADAPT_RPM_PCT < 1 || ADAPT_RPM_PCT > 99
+#error "ADAPT_RPM_PCT must be 1-99"
+#endif
+#if ADAPT_STREAK < 1 || ADAPT_STREAK > 0xFF || ADAPT_SAVE_MS > 0xFFFF
+#error "ADAPT_STREAK must fit 8 bits and ADAPT_SAVE_MS 16"
+#endif
+//@}
+#endif /* ADAPT */
+
+#endif /* CONFIG_H */
@@ -0,0 +1,65 @@
+/** @file
+ * @brief Bit-parallel debounce of an 8 bit port with vertical counters.
+ *
+ * Each pin has a two bit counter, but the counters are stored sideways:
+ * @c cnt0 holds bit 0 of all eight and @c cnt1 bit 1, so one pass of a few
+ * logic operations steps every pin at once. A counter rests at 3 while its
+ * pin agrees with the debounced state, counts down on every sample that
+ * disagrees, and is reset by any sample that agrees again. The state of a
+ * pin flips when its counter rolls over, after #DEBOUNCE_SAMPLES
+ * disagreeing samples in a row. Presses and releases are debounced alike.
+ *
+ * The cost is the same for one input or eight, so adding a button is only
+ * a matter of which bits the caller looks at.
+ *
+ * @date    10/18/2026
+ */
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H 1
+
+#include <stdint.h>
+
+#define DEBOUNCE_SAMPLES    4   ///<Samples in a row for a change
+
+/// Debounced state of eight inputs.
+typedef struct
+{
+    uint8_t cnt0;       ///< Bit 0 of each pin's counter
+    uint8_t cnt1;       ///< Bit 1 of each pin's counter
+    uint8_t state;      ///< Debounced inputs, 1 = active
+} Debounce;
+
+/**
+ * @brief Start with every counter at rest.
+ *
+ * @param   state   the inputs taken as settled
+ */
+static inline void debounce_init(Debounce *d, uint8_t state)
+{
+    d->cnt0 = 0xFF;
+    d->cnt1 = 0xFF;
+    d->state = state;
+}
+
+/**
+ * @brief Take one sample of all eight inputs.
+ *
+ * @param   sample  raw inputs, 1 = active
+ * @return  the inputs whose debounced state changed on this sample; the
+ *          presses are <tt>changed & d->state</tt> and the releases
+ *          <tt>changed & ~d->state</tt>
+ */
+static inline uint8_t debounce(Debounce *d, uint8_t sample)
+{
+    uint8_t changed = sample ^ d->state;
+
+    // Count down where the sample disagrees, back to 3 where it agrees
+    d->cnt0 = ~(d->cnt0 & changed);
+    d->cnt1 = d->cnt0 ^ (d->cnt1 & changed);
+    // Rolled over from 0 to 3
+    changed &= d->cnt0 & d->cnt1;
+    d->state ^= changed;
+    return changed;
+}
+
+#endif /* DEBOUNCE_H */
@@ -8,7 +8,27 @@
 #ifndef DEFINES_H
 #define DEFINES_H 1
 
-#include <avr/io.h>
+#include "hal.h"
+
+/** @name Build Options */
+//@{
+///Uncomment #DEBUG to print out system information.
+#define DEBUG 1
+///Uncomment #SIMULATE to run the car on the board, see plant.h
+#define SIMULATE 1
+///Uncomment #TELEMETRY to stream binary frames instead of the text printout
+#define TELEMETRY 1
+///Uncomment #BLACKBOX to keep a ring of recent events in RAM, see bbox.h
+#define BLACKBOX 1
+///Uncomment #PROFILE to time the ISRs and the main loop, see prof.h
+//#define PROFILE 1
+///Uncomment #PROF_GPIO to also show the profiled code on spare pins
+//#define PROF_GPIO 1
+///Uncomment #RAMCHECK to paint the stack and report SRAM use, see ram.h
+#define RAMCHECK 1
+///Uncomment #ADAPT to learn the shift timings of each gear, see adapt.h
+#define ADAPT 1
+//@}
 
 /** @name User Input Defines */
 //@{
@@ -21,11 +41,20 @@
 #define AUTOMATIC_PIN   PD7     ///<Mode pin\n Connect to Digital Pin 7
 #define RELEASED        0       ///<Button is released
 #define PRESSED         1       ///<Button is pressed
-#define DB_DELAY        5       ///<Debounce delay (ms)
+#define BTN_PADDLES     (_BV(USHIFT_PIN)|_BV(DSHIFT_PIN)) ///<Paddle pins
+#define BTN_MODE_PINS   (_BV(SEMIAUTO_PIN)|_BV(AUTOMATIC_PIN)) ///<Mode switch pins
+#define DB_DELAY        5       ///<Debounce delay (ms, default)
+#define BTN_LONG_PRESS_MS 500   ///<Hold time for a long press (ms)
 #define ADC_DDR         DDRC    ///<ADC DDR
 #define ADC_PORT        PORTC   ///<ADC Port
 #define ADC_PIN         PINC    ///<ADC Port Pins
 #define GAS_PEDAL       PC0     ///<Gas pedal input pin
+#define GEAR_POS_PIN    PC1     ///<Gear position pot input pin
+#define OIL_TEMP_PIN    PC2     ///<Oil temperature input pin
+#define ADC_OVERSAMPLE_BITS 2   ///<Bits gained by oversampling (0-3)
+#define ADC_THROTTLE_OVERSAMPLE_BITS 1  ///<Same, throttle (0-ADC_OVERSAMPLE_BITS)
+#define ADC_RING_LEN    4       ///<Values kept per channel (power of 2)
+#define ADC_PRESCALER   128     ///<ADC clock divider, see config.h
 //@}
 
 /** @name Solenoid Defines */
@@ -35,7 +64,29 @@
 #define SOLEN_OP_PIN    PINB    ///<Solenoid output Port Pins
 #define SOLEN_UP        PB1     ///<Solenoid Up, pulls solenoid in
 #define SOLEN_DN        PB2     ///<Solenoid Down, pushes solenoid out
-#define SOLEN_DLY       25      ///<Amount of time to hold Solenoid
+#define SOLEN_DLY       25      ///<Amount of time to hold Solenoid (default)
+#define SHIFT_SETTLE_DLY 20     ///<Hold off between shifts (ms, default)
+#define SHIFT_ENGAGE_DLY 0      ///<Solenoid release to gear engaged (ms, default)
+#define SHIFT_LEAD_PCT  50      ///<Upshift lead, % of the actuation time (default)
+#define SHIFT_LEAD_PCT_MAX 200  ///<Largest upshift lead allowed (%)
+#define SHIFT_LEAD_MAX  1500    ///<Most an upshift may be early (rpm, default)
+#define SHIFT_LEAD_AGE_MAX 1000 ///<Oldest rpm sample extrapolated (ms)
+#define SHIFT_LEAD_MARGIN 250  ///<Least gap kept above the downshift rpm
+//@}
+
+/** @name Adaptive Timing Defines
+ *  Limits and pace of the learned shift timings, see adapt.h.
+ */
+//@{
+#define ADAPT_IGN_MIN   2       ///<Shortest ignition cut (ms)
+#define ADAPT_IGN_MAX   40      ///<Longest ignition cut (ms)
+#define ADAPT_SOLEN_MIN 5       ///<Shortest solenoid hold (ms)
+#define ADAPT_SOLEN_MAX 60      ///<Longest solenoid hold (ms)
+#define ADAPT_STREAK    4       ///<Good shifts before a time is shortened
+#define ADAPT_BACKOFF_MS 3      ///<Added to a time after a miss (ms)
+#define ADAPT_RPM_PCT   5       ///<Least rpm step of a good shift (%)
+#define ADAPT_RPM_MIN   2500    ///<Shifts below this rpm are not judged
+#define ADAPT_SAVE_MS   5000    ///<Quiet time before the times are saved (ms)
 //@}
 
 /** @name ECU Defines */
@@ -45,18 +96,48 @@
 #define ECU_PIN         PIND    ///<Tachometer input Port Pins
 #define TACH_PIN        PD2     ///<Tachometer pin\n Connect to Digital Pin 2
 #define IGNITION_INT    PD3     ///<Ignition interrupt pin\n Connect to Digital Pin 3
-#define IGNITION_DLY    10      ///<Ignition kill duration
-#define PULSE_ROT       2       ///<Number of pulses per rotation
-#define RPM_HIST_LEN    10      ///<Length of RPM history
+#define IGNITION_DLY    10      ///<Ignition kill duration (default)
+#define PULSE_ROT       2       ///<Number of pulses per rotation (default)
+#define RPM_HIST_LEN    10      ///<Moving average window (0 disables)
+#define RPM_MEDIAN_LEN  3       ///<Spike rejecting median window (0, 3, 5)
+#define RPM_EMA_SHIFT   3       ///<EMA weight 1/2^n (0 disables)
+#define RPM_SLOPE       1       ///<Estimate rpm/s (0 disables)
 #define RPM_MAX         7000    ///<Maximum rpm for down shifting
+#define TACH_COUNT      0       ///<Count pulses for #TACH_SAMPLE_MS
+#define TACH_PERIOD     1       ///<Time every pulse against micros()
+#define TACH_MODE       TACH_PERIOD ///<How rpm is measured
+#define TACH_RPM_LIMIT  12000   ///<Faster edges are rejected as glitches
+#define TACH_STALL_MS   250     ///<No edge for this long reads as 0 rpm
+#define TACH_SAMPLE_MS  1000    ///<Pulse count sample period (#TACH_COUNT)
 //@}
 
 /** @name Timer Defines */
 //@{
-#define TIMER0_FREQ     1000    ///<Button pin check frequency (Hz).
-#define PRESCALER0      64      ///<Prescaler needed for Timer0.
-#define TIMER1_FREQ     1       ///<RPM sample frequency (Hz).
-#define PRESCALER1      256     ///<Prescaler needed for Timer1.
+#define TIMER0_FREQ     1000    ///<System tick frequency (Hz).
+#define PRESCALER0      64      ///<Prescaler needed for Timer0, see config.h
+///Timer0 resolution (us per count). Timer0 also provides micros().
+#define TIMER0_US_PER_TICK  (1000000UL/(F_CPU/PRESCALER0))
+#define WDT_TIMEOUT     WDTO_500MS  ///<Watchdog reset without a kick
+#define WDT_KICK_MS     100     ///<Watchdog kick period (ms)
+//@}
+
+/** @name Scheduler Defines
+ *  Periods and deadlines of the main task's tasks (ms), see sched.h.
+ */
+//@{
+#define SCHED_TIMER_DL          2   ///<Tick to timer callbacks run
+#define SCHED_PADDLE_DL         2   ///<Paddle event to shift request
+#define SCHED_SHIFT_MS          5   ///<Shift logic period without rpm samples
+#define SCHED_SHIFT_DL          2   ///<Rpm sample to shift request
+#define SCHED_PRINT_MS          2000    ///<Text printout period
+#define SCHED_PRINT_DL          50  ///<Text printout
+#define SCHED_HOUSEKEEPING_MS   10  ///<Heartbeat and serial command period
+//@}
+
+/** @name Serial Defines */
+//@{
+#define SERIAL_BAUD     Baud115200  ///<USART0 baud rate. See serial.h
+#define TLM_PERIOD_MS   10          ///<Telemetry sample period (ms)
 //@}
 
 /** @name LED Defines */
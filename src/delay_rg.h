@@ -10,7 +10,8 @@
 #ifndef _DELAY_RG_H
 #define _DELAY_RG_H 1
 
-#include <util/delay.h>
+#include <stdint.h>
+#include "hal.h"
 #define DLAY_MAX_MS (262.14/F_CPU)-1
 #define DLAY_MAX_US (768/F_CPU)-1
 
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @brief Discrete-event kernel for the host build.
+ *
+ * @date    10/18/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "des.h"
+
+/// A pending event.
+typedef struct
+{
+    uint64_t    at;     ///< Virtual time to run (us)
+    uint64_t    seq;    ///< Order of scheduling, breaks ties
+    Des_Handler fn;
+    void        *arg;
+} Des_Event;
+
+static Des_Event heap[DES_MAX_EVENTS];
+static unsigned  count;
+static uint64_t  now;
+static uint64_t  seq;
+static uint64_t  run;
+
+static int before(const Des_Event *a, const Des_Event *b)
+{
+    return a->at < b->at || (a->at == b->at && a->seq < b->seq);
+}
+
+static void swap(unsigned i, unsigned j)
+{
+    Des_Event t = heap[i];
+
+    heap[i] = heap[j];
+    heap[j] = t;
+}
+
+static void sift_up(unsigned i)
+{
+    while(i && before(&heap[i], &heap[(i-1)/2]))
+    {
+        swap(i, (i-1)/2);
+        i = (i-1)/2;
+    }
+}
+
+static void sift_down(unsigned i)
+{
+    for(;;)
+    {
+        unsigned l = 2*i+1, r = l+1, m = i;
+
+        if(l < count && before(&heap[l], &heap[m]))
+            m = l;
+        if(r < count && before(&heap[r], &heap[m]))
+            m = r;
+        if(m == i)
+            return;
+        swap(i, m);
+        i = m;
+    }
+}
+
+/**
+ * @brief Remove heap entry @c i.
+ */
+static void remove_at(unsigned i)
+{
+    heap[i] = heap[--count];
+    if(i < count)
+    {
+        sift_up(i);
+        sift_down(i);
+    }
+}
+
+void des_reset(void)
+{
+    count = 0;
+    now = 0;
+    seq = 0;
+    run = 0;
+}
+
+uint64_t des_now(void)
+{
+    return now;
+}
+
+void des_schedule(uint64_t at, Des_Handler fn, void *arg)
+{
+    if(count == DES_MAX_EVENTS)
+    {
+        fprintf(stderr, "des: event queue full\n");
+        abort();
+    }
+    heap[count].at = at;
+    heap[count].seq = seq++;
+    heap[count].fn = fn;
+    heap[count].arg = arg;
+    sift_up(count++);
+}
+
+unsigned des_cancel(Des_Handler fn, void *arg)
+{
+    unsigned kept = 0, removed;
+
+    for(unsigned i = 0; i < count; ++i)
+        if(heap[i].fn != fn || heap[i].arg != arg)
+            heap[kept++] = heap[i];
+    removed = count - kept;
+    count = kept;
+    // Rebuild: the order is fixed by (at, seq), so nothing moves in time
+    for(unsigned i = count/2; i-- > 0; )
+        sift_down(i);
+    return removed;
+}
+
+uint8_t des_pending(Des_Handler fn, void *arg)
+{
+    for(unsigned i = 0; i < count; ++i)
+        if(heap[i].fn == fn && heap[i].arg == arg)
+            return 1;
+    return 0;
+}
+
+void des_advance(uint64_t us)
+{
+    uint64_t end = now + us;
+
+    while(count && heap[0].at <= end)
+    {
+        Des_Event ev = heap[0];
+
+        remove_at(0);
+        if(ev.at > now)
+            now = ev.at;
+        ++run;
+        ev.fn(ev.arg);
+    }
+    now = end;
+}
+
+void des_run_next(void)
+{
+    if(count)
+        des_advance(heap[0].at > now ? heap[0].at - now : 0);
+}
+
+uint64_t des_events_run(void)
+{
+    return run;
+}
@@ -0,0 +1,76 @@
+/** @file
+ * @brief Discrete-event kernel for the host build.
+ *
+ * Keeps a virtual clock in microseconds and a queue of timed events. The
+ * host driver schedules the hardware as events (the Timer0
+ * compare matches, ADC completions, tachometer edges, USART bytes) and
+ * routes every firmware delay through des_advance(), which runs the events
+ * that fall due in time order and then moves the clock on. Nothing depends
+ * on the wall clock: events due at the same time run in the order they
+ * were scheduled, so a run is repeatable bit for bit.
+ *
+ * Host only. The queue is a binary heap of at most #DES_MAX_EVENTS events.
+ *
+ * @date    10/18/2026
+ */
+#ifndef DES_H
+#define DES_H 1
+
+#include <stdint.h>
+
+#define DES_MAX_EVENTS  32  ///<Events that can be pending at once
+
+/// Event handler. @c arg is the value given to des_schedule().
+typedef void (*Des_Handler)(void *arg);
+
+/**
+ * @brief Empty the queue and set the clock to 0.
+ */
+void des_reset(void);
+
+/**
+ * @return the virtual time (us)
+ */
+uint64_t des_now(void);
+
+/**
+ * @brief Run @c fn(arg) at virtual time @c at.
+ *
+ * An event in the past runs at the next des_advance(). Aborts if the
+ * queue is full, since a lost event would make the run meaningless.
+ */
+void des_schedule(uint64_t at, Des_Handler fn, void *arg);
+
+/**
+ * @brief Remove every pending @c fn(arg) event.
+ *
+ * @return the number removed
+ */
+unsigned des_cancel(Des_Handler fn, void *arg);
+
+/**
+ * @return 1 if an @c fn(arg) event is pending
+ */
+uint8_t des_pending(Des_Handler fn, void *arg);
+
+/**
+ * @brief Move the clock on by @c us, running the events that fall due.
+ *
+ * Each handler runs with the clock set to its event time and may schedule
+ * further events, including ones inside the same interval.
+ */
+void des_advance(uint64_t us);
+
+/**
+ * @brief Move the clock on to the next event and run every event due then.
+ *
+ * Does nothing if the queue is empty.
+ */
+void des_run_next(void);
+
+/**
+ * @return the number of events run since des_reset()
+ */
+uint64_t des_events_run(void);
+
+#endif /* DES_H */
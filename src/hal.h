@@ -0,0 +1,35 @@
+/** @file
+ * @brief Hardware abstraction layer.
+ *
+ * Every source file reaches the hardware through this header. For the
+ * ATmega328P it pulls in the avr-libc headers unchanged. When @c HOST is
+ * defined it substitutes the host register file from hal_host.h so the same
+ * control code builds as an ordinary executable.
+ *
+ * @date    10/18/2026
+ */
+#ifndef HAL_H
+#define HAL_H 1
+
+#ifdef HOST
+#include "hal_host.h"
+#else
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+#include <util/delay.h>
+#endif /* HOST */
+
+/**
+ * @brief Compiler memory barrier.
+ *
+ * Keeps the compiler from moving ordinary loads and stores across it. The
+ * lock-free queues shared with ISRs use it between filling a slot and
+ * publishing the index that hands the slot over.
+ */
+#define HAL_BARRIER()   __asm__ __volatile__("" ::: "memory")
+
+#endif /* HAL_H */
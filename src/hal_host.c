@@ -0,0 +1,52 @@
+/**
+ * @file
+ * @brief Host register file, EEPROM, delay, sleep and watchdog hooks.
+ *
+ * @date    10/18/2026
+ */
+#include "hal.h"
+
+volatile Hal_Io hal_io;
+uint64_t hal_delay_us_total = 0;
+void (*hal_delay_hook)(uint32_t us) = 0;
+void (*hal_sleep_hook)(void) = 0;
+uint8_t hal_eeprom[E2END+1] = {[0 ... E2END] = 0xFF};
+uint32_t hal_wdt_kicks = 0;
+
+uint8_t hal_raise(void (*vector)(void))
+{
+    if(!(SREG & _BV(SREG_I)))
+        return 0;
+
+    cli();
+    vector();
+    sei();
+    return 1;
+}
+
+void hal_delay_us(double us)
+{
+    hal_delay_us_total += (uint64_t)us;
+    if(hal_delay_hook)
+        hal_delay_hook((uint32_t)us);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    memcpy(dst, &hal_eeprom[(uintptr_t)src], n);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    memcpy(&hal_eeprom[(uintptr_t)dst], src, n);
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+    return hal_eeprom[(uintptr_t)addr];
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+    hal_eeprom[(uintptr_t)addr] = value;
+}
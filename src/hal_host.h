@@ -0,0 +1,358 @@
+/** @file
+ * @brief Host register file and ISR entry points.
+ *
+ * Replaces <avr/io.h>, <avr/interrupt.h>, <avr/pgmspace.h>,
+ * <avr/eeprom.h>, <avr/sleep.h>, <avr/wdt.h> and <util/delay.h> for the
+ * host build. The I/O registers live in a fake data space laid out at the
+ * ATmega328P addresses, so a test driver can poke pins and inspect outputs
+ * exactly where the firmware does. @c ISR() declares a plain function that
+ * the driver calls directly, and the global interrupt flag is kept in the
+ * fake @c SREG so cli()/sei() behave the same as on the part.
+ *
+ * @date    10/18/2026
+ */
+#ifndef HAL_HOST_H
+#define HAL_HOST_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** @name Register File */
+//@{
+#define HAL_IO_SIZE     0x100   ///<Size of the emulated I/O data space
+
+/// Emulated I/O data space, addressed like the ATmega328P.
+typedef union
+{
+    uint8_t  b[HAL_IO_SIZE];        ///<Byte view
+    uint16_t w[HAL_IO_SIZE/2];      ///<Word view, for 16 bit registers
+} Hal_Io;
+
+extern volatile Hal_Io hal_io;  ///<The fake register file
+
+#define _SFR_MEM8(addr)     (hal_io.b[(addr)])
+#define _SFR_MEM16(addr)    (hal_io.w[(addr)>>1])
+#define _BV(bit)            (1 << (bit))
+//@}
+
+/** @name I/O Ports */
+//@{
+#define PINB    _SFR_MEM8(0x23)
+#define DDRB    _SFR_MEM8(0x24)
+#define PORTB   _SFR_MEM8(0x25)
+#define PINC    _SFR_MEM8(0x26)
+#define DDRC    _SFR_MEM8(0x27)
+#define PORTC   _SFR_MEM8(0x28)
+#define PIND    _SFR_MEM8(0x29)
+#define DDRD    _SFR_MEM8(0x2A)
+#define PORTD   _SFR_MEM8(0x2B)
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+//@}
+
+/** @name Status Register */
+//@{
+#define SREG    _SFR_MEM8(0x5F)
+#define SREG_I  7
+//@}
+
+/** @name External Interrupts */
+//@{
+#define EIFR    _SFR_MEM8(0x3C)
+#define EIMSK   _SFR_MEM8(0x3D)
+#define EICRA   _SFR_MEM8(0x69)
+#define INT0    0
+#define INT1    1
+#define INTF0   0
+#define INTF1   1
+#define ISC00   0
+#define ISC01   1
+#define ISC10   2
+#define ISC11   3
+//@}
+
+/** @name Timer 0 */
+//@{
+#define TIFR0   _SFR_MEM8(0x35)
+#define TCCR0A  _SFR_MEM8(0x44)
+#define TCCR0B  _SFR_MEM8(0x45)
+#define TCNT0   _SFR_MEM8(0x46)
+#define OCR0A   _SFR_MEM8(0x47)
+#define OCR0B   _SFR_MEM8(0x48)
+#define TIMSK0  _SFR_MEM8(0x6E)
+#define WGM00   0
+#define WGM01   1
+#define CS00    0
+#define CS01    1
+#define CS02    2
+#define WGM02   3
+#define TOIE0   0
+#define OCIE0A  1
+#define OCIE0B  2
+#define TOV0    0
+#define OCF0A   1
+#define OCF0B   2
+//@}
+
+/** @name Timer 1 */
+//@{
+#define TIFR1   _SFR_MEM8(0x36)
+#define TIMSK1  _SFR_MEM8(0x6F)
+#define TCCR1A  _SFR_MEM8(0x80)
+#define TCCR1B  _SFR_MEM8(0x81)
+#define TCCR1C  _SFR_MEM8(0x82)
+#define TCNT1   _SFR_MEM16(0x84)
+#define ICR1    _SFR_MEM16(0x86)
+#define OCR1A   _SFR_MEM16(0x88)
+#define OCR1B   _SFR_MEM16(0x8A)
+#define WGM10   0
+#define WGM11   1
+#define CS10    0
+#define CS11    1
+#define CS12    2
+#define WGM12   3
+#define WGM13   4
+#define ICES1   6
+#define ICNC1   7
+#define TOIE1   0
+#define OCIE1A  1
+#define OCIE1B  2
+#define ICIE1   5
+#define TOV1    0
+#define OCF1A   1
+#define OCF1B   2
+#define ICF1    5
+//@}
+
+/** @name Timer 2 */
+//@{
+#define TIFR2   _SFR_MEM8(0x37)
+#define TIMSK2  _SFR_MEM8(0x70)
+#define TCCR2A  _SFR_MEM8(0xB0)
+#define TCCR2B  _SFR_MEM8(0xB1)
+#define TCNT2   _SFR_MEM8(0xB2)
+#define OCR2A   _SFR_MEM8(0xB3)
+#define OCR2B   _SFR_MEM8(0xB4)
+#define CS20    0
+#define CS21    1
+#define CS22    2
+#define TOIE2   0
+#define OCIE2A  1
+#define TOV2    0
+#define OCF2A   1
+//@}
+
+/** @name ADC */
+//@{
+#define ADC     _SFR_MEM16(0x78)
+#define ADCL    _SFR_MEM8(0x78)
+#define ADCH    _SFR_MEM8(0x79)
+#define ADCSRA  _SFR_MEM8(0x7A)
+#define ADCSRB  _SFR_MEM8(0x7B)
+#define ADMUX   _SFR_MEM8(0x7C)
+#define DIDR0   _SFR_MEM8(0x7E)
+#define ADPS0   0
+#define ADPS1   1
+#define ADPS2   2
+#define ADIE    3
+#define ADIF    4
+#define ADATE   5
+#define ADSC    6
+#define ADEN    7
+#define ADTS0   0
+#define ADTS1   1
+#define ADTS2   2
+#define MUX0    0
+#define MUX1    1
+#define MUX2    2
+#define MUX3    3
+#define ADLAR   5
+#define REFS0   6
+#define REFS1   7
+//@}
+
+/** @name USART 0 */
+//@{
+#define UCSR0A  _SFR_MEM8(0xC0)
+#define UCSR0B  _SFR_MEM8(0xC1)
+#define UCSR0C  _SFR_MEM8(0xC2)
+#define UBRR0L  _SFR_MEM8(0xC4)
+#define UBRR0H  _SFR_MEM8(0xC5)
+#define UDR0    _SFR_MEM8(0xC6)
+#define MPCM0   0
+#define U2X0    1
+#define UPE0    2
+#define DOR0    3
+#define FE0     4
+#define UDRE0   5
+#define TXC0    6
+#define RXC0    7
+#define TXB80   0
+#define RXB80   1
+#define UCSZ02  2
+#define TXEN0   3
+#define RXEN0   4
+#define UDRIE0  5
+#define TXCIE0  6
+#define RXCIE0  7
+#define UCPOL0  0
+#define UCSZ00  1
+#define UCSZ01  2
+#define USBS0   3
+#define UPM00   4
+#define UPM01   5
+//@}
+
+/** @name Interrupts
+ *  An ISR is an ordinary function on the host. The driver calls it through
+ *  hal_raise() so the global interrupt flag is honoured.
+ */
+//@{
+#define ISR(vector)     void vector(void)
+#define sei()           (SREG |= _BV(SREG_I))
+#define cli()           (SREG &= ~_BV(SREG_I))
+
+/**
+ * @brief Run @c vector if global interrupts are enabled.
+ *
+ * The flag is cleared for the duration of the handler, as the hardware does
+ * on entry, and restored on return.
+ *
+ * @param   vector  ISR to run
+ * @return  1 if the ISR ran, 0 if interrupts were disabled
+ */
+uint8_t hal_raise(void (*vector)(void));
+//@}
+
+/** @name Program Memory
+ *  The host has one address space, so flash tables are ordinary constants.
+ */
+//@{
+#define PROGMEM
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t *)(addr))
+#define memcpy_P(dst, src, n)   memcpy((dst), (src), (n))
+//@}
+
+/** @name EEPROM
+ *  A byte array standing in for the 1 KiB EEPROM, erased (0xFF) at start.
+ *  The driver may load an image into #hal_eeprom before shifter_init().
+ */
+//@{
+#define E2END   0x3FF   ///<Last EEPROM address
+
+extern uint8_t hal_eeprom[E2END+1];    ///<The fake EEPROM
+
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+uint8_t eeprom_read_byte(const uint8_t *addr);
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+#define eeprom_is_ready()   1   ///<Writes complete at once
+//@}
+
+/** @name Delays
+ *  Busy waits cost nothing on the host. They are accumulated in
+ *  #hal_delay_us_total and handed to #hal_delay_hook, which lets the driver
+ *  advance its own clock and raise the timer ISRs a spinning loop is
+ *  waiting on.
+ */
+//@{
+extern uint64_t hal_delay_us_total;         ///<Total time spent in delays (us)
+extern void (*hal_delay_hook)(uint32_t us); ///<Called for every delay
+
+/**
+ * @brief Record a busy wait of @c us microseconds.
+ *
+ * @param   us  length of the delay in microseconds
+ */
+void hal_delay_us(double us);
+
+#define _delay_ms(ms)   hal_delay_us((ms)*1000.0)
+#define _delay_us(us)   hal_delay_us((us))
+//@}
+
+/** @name Sleep
+ *  sleep_cpu() hands over to #hal_sleep_hook, which lets the driver run
+ *  its clock on to the next interrupt. Without a hook it returns at once.
+ */
+//@{
+#define SMCR    _SFR_MEM8(0x53)
+#define SE      0
+#define SM0     1
+#define SM1     2
+#define SM2     3
+
+#define SLEEP_MODE_IDLE     0
+
+extern void (*hal_sleep_hook)(void);    ///<Called for every sleep
+
+#define set_sleep_mode(mode)    (SMCR = (SMCR & ~(_BV(SM0)|_BV(SM1)|_BV(SM2))) \
+                                        | (mode))
+#define sleep_enable()          (SMCR |= _BV(SE))
+#define sleep_disable()         (SMCR &= ~_BV(SE))
+#define sleep_cpu()             do { if(hal_sleep_hook) hal_sleep_hook(); } \
+                                while(0)
+//@}
+
+/** @name Watchdog
+ *  The registers only hold what the firmware writes. wdt_reset() counts
+ *  kicks in #hal_wdt_kicks, and the driver checks the time between them
+ *  against the timeout wdt_enable() set.
+ */
+//@{
+#define MCUSR   _SFR_MEM8(0x54)
+#define WDTCSR  _SFR_MEM8(0x60)
+#define PORF    0
+#define EXTRF   1
+#define BORF    2
+#define WDRF    3
+#define WDP0    0
+#define WDP1    1
+#define WDP2    2
+#define WDE     3
+#define WDCE    4
+#define WDP3    5
+#define WDIE    6
+#define WDIF    7
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+
+extern uint32_t hal_wdt_kicks;  ///<wdt_reset() calls
+
+#define wdt_enable(value)   (WDTCSR = _BV(WDE) | (value))
+#define wdt_disable()       (WDTCSR = 0)
+#define wdt_reset()         (++hal_wdt_kicks)
+//@}
+
+#endif /* HAL_HOST_H */
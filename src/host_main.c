@@ -0,0 +1,901 @@
+/**
+ *  @file
+ *  @brief Host driver for the main task.
+ *
+ *  Runs shifter_init() and shifter_step() as an ordinary executable on the
+ *  discrete-event kernel in des.h. Time is virtual: every delay in the
+ *  firmware advances the kernel clock through #hal_delay_hook, every sleep
+ *  runs it on to the next event through #hal_sleep_hook, and the hardware
+ *  runs as events:
+ *   - the Timer0 compare match every millisecond, which updates the input
+ *     pins and the throttle and raises the button tick
+ *   - the ADC conversion it triggers, completing #ADC_CONV_US later
+ *   - each byte the USART shifts out, one byte time apart
+ *   - tachometer edges
+ *
+ *  The car is the model in plant.h, driven by the throttle and the
+ *  firmware's ignition and solenoid outputs. In a #SIMULATE build the
+ *  firmware steps it and loops its tachometer pulses back to INT0 through
+ *  the pin, and the driver raises INT0 on those edges as the part would.
+ *  Otherwise the driver steps it, and raises INT0 at the exact time of each
+ *  edge.
+ *
+ *  The driver also stands in for the watchdog: once wdt_enable() has been
+ *  called, every timeout that passes without a wdt_reset() counts as a
+ *  watchdog reset in the report. The run goes on regardless.
+ *
+ *  Runs are deterministic: the same options give the same output, and the
+ *  digest printed at the end covers every byte sent.
+ *
+ *  Usage: SAE_AutoShifter_host [-n steps | -t seconds]
+ *                              [-m manual|semi|auto] [-q] [-e eeprom.bin]
+ *                              [-o eeprom.bin] [-s text] [-r trace]
+ *         SAE_AutoShifter_host -p [-e eeprom.bin] [-j jobs] [-w ms]
+ *                              trace...
+ *
+ *  @c -e loads a raw EEPROM image, as written by calib_gen -b, before boot.
+ *  @c -o writes the EEPROM out after the run, so the next run can start
+ *  with the shift timings this one learned, see adapt.h.
+ *  @c -s types @c text into the serial port at the end of the run, one
+ *  byte time per character, and runs on for a second so the replies get
+ *  out; e.g. @c -s p for the #PROFILE report, or
+ *  <tt>-s "set ign 12;stat"</tt> for the command line in cmd.h.
+ *  @c -r records the inputs and the shifts of the run as a trace, see
+ *  trace.h.
+ *
+ *  With @c -p the inputs come from recorded traces instead of the plant:
+ *  each trace is replayed through the firmware sample for sample, and the
+ *  shifts it makes are matched against the recorded ones, in the same
+ *  direction within @c -w ms (#REPLAY_WINDOW_MS by default). Every session
+ *  runs in its own process, @c -j at a time, so thousands can be checked
+ *  against a new calibration in one go. Sessions that diverge are listed,
+ *  and the exit status is 1 if there are any.
+ *
+ *  @date    10/18/2026
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "SAE_AutoShifter.h"
+#include "serial.h"
+#include "shift.h"
+#include "calib.h"
+#include "adc.h"
+#include "plant.h"
+#include "des.h"
+#include "sched.h"
+#include "trace.h"
+#include "adapt.h"
+
+#define ADC_CONV_US 104     ///<13 ADC clocks at F_CPU/128
+#define REPLAY_WINDOW_MS    100     ///<Default shift match window
+/**
+ * Run on after the last trace event, for late shifts. The recording ends
+ * with the engine running, so the tail stops short of a stall.
+ */
+#define REPLAY_TAIL_US      ((TACH_STALL_MS-1)*1000UL)
+
+/// Mode switch pins that read high in each #Mode
+static const uint8_t mode_high[] =
+    {_BV(SEMIAUTO_PIN)|_BV(AUTOMATIC_PIN), _BV(AUTOMATIC_PIN),
+     _BV(SEMIAUTO_PIN)};
+
+/// Shift events of a session.
+typedef struct
+{
+    Trace_Event *ev;
+    unsigned    n, cap;
+} Shift_List;
+
+/// Outcome of one replayed session, sent back by its process.
+typedef struct
+{
+    unsigned      session;  ///< Index of the trace
+    uint8_t       done;     ///< The replay ran to the end
+    uint8_t       ok;       ///< The trace could be read
+    unsigned long events;   ///< Trace events replayed
+    Trace_Result  r;
+} Replay_Report;
+
+static uint8_t  mode_pins = _BV(SEMIAUTO_PIN)|_BV(AUTOMATIC_PIN);
+static uint32_t shifts = 0;     ///<Solenoid pulses seen on the outputs
+static uint16_t analog[8];      ///<Voltage on each ADC input (0-1023)
+static uint16_t adc_sample;     ///<Input sampled by the running conversion
+static uint64_t distance = 0;   ///<Distance driven (um)
+static uint32_t digest = 2166136261u;   ///<FNV-1a of the bytes sent
+static const char *rx_text = "";    ///<Still to be received
+static uint64_t ms_serviced;    ///<Last Timer0 compare match serviced (us)
+static FILE     *rec;           ///<Trace being recorded, -r
+static uint32_t wdt_resets = 0; ///<Watchdog timeouts without a kick
+
+static FILE     *play;          ///<Trace being replayed, -p
+static Trace_Event next;        ///<Its next event
+static uint8_t  have_next;      ///<@c next is valid
+static uint8_t  play_bad;       ///<The trace has a bad line
+static uint64_t play_end;       ///<Stop here once the trace is used up
+static unsigned long play_events;   ///<Events replayed
+static Shift_List recorded, replayed;   ///<Shifts in the trace and made
+
+/**
+ * @brief Time to send one byte, as programmed by init_usart().
+ *
+ * Each byte takes ten bit times.
+ */
+static uint64_t uart_byte_us(void)
+{
+    uint32_t ubrr = ((uint32_t)UBRR0H << 8) | UBRR0L;
+    uint32_t div = (UCSR0A & _BV(U2X0)) ? 8 : 16;
+
+    return (uint64_t)10*1000000*div*(ubrr+1)/F_CPU;
+}
+
+/**
+ * @brief Append a shift to @c l.
+ */
+static void shift_push(Shift_List *l, const Trace_Event *ev)
+{
+    if(l->n == l->cap)
+    {
+        l->cap = l->cap ? 2*l->cap : 64;
+        if(!(l->ev = realloc(l->ev, l->cap*sizeof(*l->ev))))
+        {
+            perror("replay");
+            exit(1);
+        }
+    }
+    l->ev[l->n++] = *ev;
+}
+
+/**
+ * @brief Add an event at the current time to the trace being recorded.
+ */
+static void record(uint8_t ch, int16_t value)
+{
+    Trace_Event ev = {des_now(), ch, value};
+
+    if(rec)
+        trace_write(rec, &ev);
+}
+
+/**
+ * @brief Record the sampled inputs that changed since the last call.
+ */
+static void record_inputs(void)
+{
+    static uint8_t first = 1;
+    static int16_t prev[TRACE_CHANNELS];
+    int16_t v[TRACE_CHANNELS];
+
+    v[TRACE_TPS]  = analog[GAS_PEDAL];
+    v[TRACE_UP]   = !(PIND & _BV(USHIFT_PIN));
+    v[TRACE_DN]   = !(PIND & _BV(DSHIFT_PIN));
+    v[TRACE_MODE] = !(PIND & _BV(SEMIAUTO_PIN)) ? semi_man :
+                    !(PIND & _BV(AUTOMATIC_PIN)) ? automated : manual;
+    for(uint8_t ch = TRACE_TPS; ch <= TRACE_MODE; ++ch)
+        if(first || v[ch] != prev[ch])
+        {
+            record(ch, v[ch]);
+            prev[ch] = v[ch];
+        }
+    first = 0;
+}
+
+/**
+ * @brief Event: the USART is ready for the next byte.
+ *
+ * The byte the ISR loads goes to stdout and the line is busy for one byte
+ * time. When the ISR has nothing to send the line goes idle.
+ */
+static void uart_event(void *arg)
+{
+    (void)arg;
+    if(!(UCSR0B & _BV(TXEN0)) || !(UCSR0B & _BV(UDRIE0)))
+        return;
+    if(!hal_raise(USART_UDRE_vect))
+    {
+        // Interrupts off: try again shortly
+        des_schedule(des_now() + 1, uart_event, 0);
+        return;
+    }
+    if(UCSR0B & _BV(UDRIE0))
+    {
+        uint8_t c = UDR0;
+
+        putchar(c);
+        digest = (digest ^ c)*16777619u;
+        des_schedule(des_now() + uart_byte_us(), uart_event, 0);
+    }
+}
+
+/**
+ * @brief Event: the next byte of #rx_text arrives.
+ *
+ * UDR0 is one register in the host register file, so a byte is only
+ * delivered while the transmitter is idle. A byte that arrived with
+ * interrupts disabled is raised again on the next event.
+ */
+static void rx_event(void *arg)
+{
+    (void)arg;
+    if((UCSR0A & _BV(RXC0)) && (UCSR0B & _BV(RXCIE0)))
+        hal_raise(USART_RX_vect);
+    if(!*rx_text)
+        return;
+    if((UCSR0B & _BV(UDRIE0)) || (UCSR0A & _BV(RXC0)))
+    {
+        des_schedule(des_now() + uart_byte_us(), rx_event, 0);
+        return;
+    }
+    UDR0 = *rx_text++;
+    UCSR0A |= _BV(RXC0);
+    if(UCSR0B & _BV(RXCIE0))
+        hal_raise(USART_RX_vect);
+    des_schedule(des_now() + uart_byte_us(), rx_event, 0);
+}
+
+/**
+ * @brief Update the inputs for millisecond @c ms.
+ *
+ * The throttle sweeps up and down over ten seconds, the gear position pot
+ * follows the gear and the oil temperature holds at mid scale. In manual
+ * mode the driver taps the upshift paddle for 20 ms every two seconds, and
+ * the downshift paddle once every seven.
+ */
+static void drive_inputs(uint64_t ms)
+{
+    uint8_t pins = mode_pins;
+    uint32_t phase = ms % 10000;
+
+    analog[GAS_PEDAL] = phase < 5000 ? phase*1023/5000
+                                     : (10000-phase)*1023/5000;
+    analog[GEAR_POS_PIN] = plant.gear*1023/MAX_GEARS;
+    analog[OIL_TEMP_PIN] = 512;
+
+    if(ms % 2000 >= 20)
+        pins |= _BV(USHIFT_PIN);
+    if(ms % 7000 >= 20)
+        pins |= _BV(DSHIFT_PIN);
+
+    PIND = (PIND & ~(_BV(USHIFT_PIN)|_BV(DSHIFT_PIN)|
+                     _BV(SEMIAUTO_PIN)|_BV(AUTOMATIC_PIN))) | pins;
+}
+
+/**
+ * @brief Position Timer0 within the millisecond, as micros() reads it.
+ *
+ * At a millisecond boundary the compare match flag stays set until
+ * ms_event() has raised the interrupt, so an edge timed just before it
+ * reads the same micros() as one just after.
+ */
+static void sync_timer0(void)
+{
+    uint64_t now = des_now();
+
+    TCNT0 = (now % 1000)/TIMER0_US_PER_TICK;
+    if(now - now % 1000 > ms_serviced)
+        TIFR0 |= _BV(OCF0A);
+    else
+        TIFR0 &= ~_BV(OCF0A);
+}
+
+/**
+ * @brief Raise INT0 for a tachometer edge at the current time.
+ */
+static void tach_edge(void)
+{
+    record(TRACE_TACH, 1);
+    sync_timer0();
+    if(EIMSK & _BV(INT0))
+        hal_raise(INT0_vect);
+}
+
+/**
+ * @brief Act on one replayed trace event.
+ */
+static void play_apply(const Trace_Event *ev)
+{
+    switch(ev->ch)
+    {
+        case TRACE_TACH:
+            tach_edge();
+            break;
+        case TRACE_TPS:
+            analog[GAS_PEDAL] = ev->value;
+            break;
+        case TRACE_UP:
+        case TRACE_DN:
+        {
+            uint8_t pin = ev->ch == TRACE_UP ? USHIFT_PIN : DSHIFT_PIN;
+
+            PIND = ev->value ? PIND & ~_BV(pin) : PIND | _BV(pin);
+            break;
+        }
+        case TRACE_MODE:
+            if(ev->value >= 0 && ev->value <= automated)
+                mode_pins = mode_high[ev->value];
+            PIND = (PIND & ~(_BV(SEMIAUTO_PIN)|_BV(AUTOMATIC_PIN))) |
+                   mode_pins;
+            break;
+        default:
+            shift_push(&recorded, ev);
+            break;
+    }
+}
+
+/**
+ * @brief Read the next event of the trace being replayed.
+ */
+static void play_read(void)
+{
+    int r = trace_read(play, &next);
+
+    have_next = r > 0;
+    if(r < 0)
+        play_bad = 1;
+    if(!have_next)
+        play_end = des_now() + REPLAY_TAIL_US;
+}
+
+/**
+ * @brief Replay the trace up to @c now.
+ *
+ * @param   tach    0 to hold back tachometer edges due at @c now
+ */
+static void play_until(uint64_t now, uint8_t tach)
+{
+    while(have_next && next.us <= now && (tach || next.ch != TRACE_TACH))
+    {
+        play_apply(&next);
+        ++play_events;
+        play_read();
+    }
+}
+
+static void play_event(void *arg);
+
+/**
+ * @brief Schedule the next trace event, unless ms_event() will take it.
+ */
+static void play_schedule(void)
+{
+    if(have_next && next.us % 1000 && !des_pending(play_event, 0))
+        des_schedule(next.us, play_event, 0);
+}
+
+/**
+ * @brief Event: a trace event between millisecond boundaries, a
+ * tachometer edge as a rule.
+ */
+static void play_event(void *arg)
+{
+    (void)arg;
+    play_until(des_now(), 1);
+    play_schedule();
+}
+
+#ifdef SIMULATE
+/**
+ * @brief INT0 fires on the output pin the plant model drives.
+ */
+static void tach_follow(void)
+{
+    static uint8_t prev = 0;
+    uint8_t pin = ECU_PORT & _BV(TACH_PIN);
+
+    if(pin & ~prev)
+        tach_edge();
+    prev = pin;
+}
+
+/**
+ * @brief Event: Timer0 compare B, which places a simulated edge.
+ */
+static void compb_event(void *arg)
+{
+    (void)arg;
+    if(!(TIMSK0 & _BV(OCIE0B)))
+        return;
+    sync_timer0();
+    hal_raise(TIMER0_COMPB_vect);
+    // A replay supplies its own edges
+    if(!play)
+        tach_follow();
+}
+#else
+/**
+ * @brief The firmware outputs the plant model responds to.
+ */
+static uint8_t plant_outputs(void)
+{
+    uint8_t out = 0;
+
+    if(ECU_PORT & _BV(IGNITION_INT))
+        out |= PLANT_IGN_CUT;
+    if(SOLEN_OP_PORT & _BV(SOLEN_UP))
+        out |= PLANT_SOLEN_UP;
+    if(SOLEN_OP_PORT & _BV(SOLEN_DN))
+        out |= PLANT_SOLEN_DN;
+    return out;
+}
+
+/**
+ * @brief Event: a tachometer edge of the plant's engine.
+ */
+static void tach_event(void *arg)
+{
+    tach_edge();
+    des_schedule(des_now() + 60000000UL/((uint32_t)plant.rpm*calib.pulse_rot),
+                 tach_event, 0);
+}
+#endif  /* SIMULATE */
+
+/**
+ * @brief Event: an ADC conversion completes.
+ */
+static void adc_event(void *arg)
+{
+    (void)arg;
+    ADC = adc_sample;
+    if(ADCSRA & _BV(ADIE))
+        hal_raise(ADC_vect);
+}
+
+/**
+ * @brief Count a watchdog reset for every timeout without a kick.
+ */
+static void watchdog(uint64_t now)
+{
+    static uint32_t kicks;
+    static uint64_t kicked;
+
+    if(!(WDTCSR & _BV(WDE)) || hal_wdt_kicks != kicks)
+    {
+        kicks = hal_wdt_kicks;
+        kicked = now;
+    }else if(now - kicked >= 16000UL << (WDTCSR & 0x07))
+    {
+        ++wdt_resets;
+        kicked = now;
+    }
+}
+
+/**
+ * @brief Event: the Timer0 compare match, every millisecond.
+ *
+ * Also starts the peripheral whose enable the driver cannot see being
+ * written: the USART.
+ */
+static void ms_event(void *arg)
+{
+    static uint8_t solen_prev = 0;
+    uint64_t now = des_now();
+    uint8_t solen;
+
+    (void)arg;
+    des_schedule(now + 1000, ms_event, 0);
+    sync_timer0();
+    if(play)
+    {
+        // Inputs first; edges at the boundary follow the interrupt
+        play_until(now, 0);
+        analog[GEAR_POS_PIN] = gear_num()*1023/MAX_GEARS;
+        analog[OIL_TEMP_PIN] = 512;
+    }else
+    {
+        drive_inputs(now/1000);
+        record_inputs();
+#ifndef SIMULATE
+        plant_step(analog[GAS_PEDAL] >> 2, plant_outputs());
+#endif
+    }
+    if(TIMSK0 & _BV(OCIE0A))
+        hal_raise(TIMER0_COMPA_vect);
+    ms_serviced = now;
+    TIFR0 &= ~_BV(OCF0A);
+    if(play)
+    {
+        play_until(now, 1);
+        play_schedule();
+    }
+#ifdef SIMULATE
+    else
+        tach_follow();
+    // The next edge, if any, comes from Timer0 compare B
+    if(TIMSK0 & _BV(OCIE0B))
+        des_schedule(now + OCR0B*TIMER0_US_PER_TICK, compb_event, 0);
+#endif
+    // Conversion triggered by the same compare match
+    if((ADCSRA & _BV(ADEN)) && (ADCSRA & _BV(ADATE)) &&
+       (ADCSRB & (_BV(ADTS2)|_BV(ADTS1)|_BV(ADTS0))) ==
+       (_BV(ADTS1)|_BV(ADTS0)))
+    {
+        adc_sample = analog[ADMUX & 0x07];
+        des_schedule(now + ADC_CONV_US, adc_event, 0);
+    }
+
+    if((UCSR0B & _BV(TXEN0)) && (UCSR0B & _BV(UDRIE0)) &&
+       !des_pending(uart_event, 0))
+        des_schedule(now, uart_event, 0);
+
+    solen = SOLEN_OP_PORT & (_BV(SOLEN_UP)|_BV(SOLEN_DN));
+    if(solen & ~solen_prev)
+    {
+        Trace_Event ev = {now, TRACE_SHIFT, solen & _BV(SOLEN_UP) ? 1 : -1};
+
+        ++shifts;
+        record(TRACE_SHIFT, ev.value);
+        if(play)
+            shift_push(&replayed, &ev);
+    }
+    solen_prev = solen;
+    distance += plant_speed();
+    watchdog(now);
+}
+
+/**
+ * @brief #hal_delay_hook: move the virtual clock forward.
+ */
+static void advance(uint32_t us)
+{
+    des_advance(us);
+    sync_timer0();
+}
+
+/**
+ * @brief #hal_sleep_hook: run the clock on to the next event.
+ */
+static void sleep_cpu_host(void)
+{
+    des_run_next();
+    sync_timer0();
+}
+
+/**
+ * @brief Load a raw EEPROM image from @c path.
+ */
+static void load_eeprom(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+
+    if(!f)
+    {
+        perror(path);
+        exit(1);
+    }
+    if(!fread(hal_eeprom, 1, sizeof(hal_eeprom), f))
+        fprintf(stderr, "%s: empty image\n", path);
+    fclose(f);
+}
+
+/**
+ * @brief Write the EEPROM out as a raw image to @c path.
+ */
+static void save_eeprom(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if(!f ||
+       fwrite(hal_eeprom, 1, sizeof(hal_eeprom), f) != sizeof(hal_eeprom))
+        perror(path);
+    if(f)
+        fclose(f);
+}
+
+/**
+ * @brief Reset the virtual hardware and boot the firmware.
+ */
+static void boot(void)
+{
+    // Pull-ups: every input reads high until the driver says otherwise
+    PIND = 0xFF;
+    des_reset();
+    hal_delay_hook = advance;
+    hal_sleep_hook = sleep_cpu_host;
+    des_schedule(1000, ms_event, 0);
+    if(play)
+    {
+        // The trace starts at power on, before the firmware is up
+        play_read();
+        play_schedule();
+    }
+#ifndef SIMULATE
+    else
+    {
+        plant_init();
+        des_schedule(0, tach_event, 0);
+    }
+#endif
+    shifter_init();
+}
+
+/**
+ * @brief Replay one trace and compare its shifts, in a process of its own.
+ */
+static void replay_session(const char *path, uint32_t window_us,
+                           Replay_Report *rep)
+{
+    rep->done = 1;
+    if(!(play = fopen(path, "r")))
+    {
+        perror(path);
+        return;
+    }
+    // The serial output of a replay is not wanted
+    if(!freopen("/dev/null", "w", stdout))
+        perror("freopen");
+
+    boot();
+    while(have_next || des_now() < play_end)
+        shifter_step();
+    fclose(play);
+
+    rep->ok = !play_bad;
+    rep->events = play_events;
+    trace_compare(recorded.ev, recorded.n, replayed.ev, replayed.n,
+                  window_us, &rep->r);
+}
+
+/**
+ * @brief Print a session that diverged or could not be replayed.
+ *
+ * @return 1 if it did either
+ */
+static int replay_problem(const char *path, const Replay_Report *rep)
+{
+    const Trace_Result *r = &rep->r;
+
+    if(!rep->done)
+        printf("%s: replay failed\n", path);
+    else if(!rep->ok)
+        printf("%s: bad trace\n", path);
+    else if(r->missing || r->extra)
+        printf("%s: diverged at %.3f s, %u missing, %u extra of %u\n",
+               path, r->first_us/1e6, r->missing, r->extra, r->recorded);
+    else
+        return 0;
+    return 1;
+}
+
+/**
+ * @brief Replay every trace, @c jobs at a time, and report.
+ *
+ * @return the exit status: 1 if any session diverged
+ */
+static int replay(char **paths, unsigned n, unsigned jobs, uint32_t window_us)
+{
+    Replay_Report *reps = calloc(n, sizeof(*reps));
+    unsigned started = 0, running = 0, diverged = 0;
+    unsigned long events = 0, matched = 0, shifts = 0;
+    int64_t delta_sum = 0, delta_max = 0;
+    struct timespec t0, t1;
+    double wall;
+    int fd[2];
+
+    if(!reps || pipe(fd))
+    {
+        perror("replay");
+        return 1;
+    }
+    // Reports are drained after every exit, so no child blocks on a full pipe
+    fcntl(fd[0], F_SETFL, O_NONBLOCK);
+    for(unsigned i = 0; i < n; ++i)
+        reps[i].session = i;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while(started < n || running)
+    {
+        Replay_Report rep;
+
+        if(started < n && running < jobs)
+        {
+            pid_t pid;
+
+            fflush(stdout);
+            if((pid = fork()) < 0)
+            {
+                perror("fork");
+                return 1;
+            }
+            if(!pid)
+            {
+                rep = reps[started];
+                replay_session(paths[started], window_us, &rep);
+                if(write(fd[1], &rep, sizeof(rep)) != sizeof(rep))
+                    _exit(1);
+                _exit(0);
+            }
+            ++started;
+            ++running;
+            continue;
+        }
+        if(wait(NULL) > 0)
+            --running;
+        while(read(fd[0], &rep, sizeof(rep)) == sizeof(rep))
+            reps[rep.session] = rep;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    // A session that never reported died, e.g. on a full event queue
+    for(unsigned i = 0; i < n; ++i)
+    {
+        const Trace_Result *r = &reps[i].r;
+
+        diverged += replay_problem(paths[i], &reps[i]);
+        events += reps[i].events;
+        shifts += r->recorded;
+        matched += r->matched;
+        delta_sum += r->delta_sum;
+        if(llabs(r->delta_max) > llabs(delta_max))
+            delta_max = r->delta_max;
+    }
+
+    wall = (t1.tv_sec-t0.tv_sec) + (t1.tv_nsec-t0.tv_nsec)/1e9;
+    fprintf(stderr, "sessions   %u\n", n);
+    fprintf(stderr, "diverged   %u\n", diverged);
+    fprintf(stderr, "shifts     %lu of %lu matched\n", matched, shifts);
+    fprintf(stderr, "delta      %.3f ms mean, %.3f ms worst\n",
+            matched ? delta_sum/1e3/matched : 0.0, delta_max/1e3);
+    fprintf(stderr, "samples    %lu\n", events);
+    fprintf(stderr, "wall       %.3f s\n", wall);
+    fprintf(stderr, "samples/s  %.0f\n", wall > 0 ? events/wall : 0.0);
+    free(reps);
+    return diverged != 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-n steps | -t seconds] "
+            "[-m manual|semi|auto] [-q] [-e eeprom.bin] [-o eeprom.bin] "
+            "[-s text] [-r trace]\n"
+            "       %s -p [-e eeprom.bin] [-j jobs] [-w ms] trace...\n",
+            prog, prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long steps = 1000000, i;
+    uint64_t until = 0;
+    struct timespec t0, t1;
+    double wall;
+    Calib ee;
+    uint8_t calibrated;
+    unsigned late = 0, jobs = 1;
+    uint32_t window_us = REPLAY_WINDOW_MS*1000UL;
+    uint8_t replaying = 0;
+    const char *eeprom_out = 0;
+#ifdef ADAPT
+    Adapt learned;
+    uint8_t adapted;
+#endif
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:t:m:qe:o:s:r:pj:w:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                steps = strtoul(optarg, 0, 0);
+                break;
+            case 't':
+                until = (uint64_t)(strtod(optarg, 0)*1e6);
+                break;
+            case 'm':
+                if(!strcmp(optarg, "semi"))
+                    mode_pins = mode_high[semi_man];
+                else if(!strcmp(optarg, "auto"))
+                    mode_pins = mode_high[automated];
+                else if(strcmp(optarg, "manual"))
+                    usage(argv[0]);
+                break;
+            case 'e':
+                load_eeprom(optarg);
+                break;
+            case 'o':
+                eeprom_out = optarg;
+                break;
+            case 's':
+                rx_text = optarg;
+                break;
+            case 'q':
+                if(!freopen("/dev/null", "w", stdout))
+                    perror("freopen");
+                break;
+            case 'r':
+                if(!(rec = fopen(optarg, "w")))
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                fprintf(rec, "# us channel value\n");
+                break;
+            case 'p':
+                replaying = 1;
+                break;
+            case 'j':
+                jobs = strtoul(optarg, 0, 0);
+                break;
+            case 'w':
+                window_us = strtoul(optarg, 0, 0)*1000UL;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if(replaying)
+    {
+        if(optind == argc || !jobs)
+            usage(argv[0]);
+        return replay(argv+optind, argc-optind, jobs, window_us);
+    }
+
+    boot();
+    eeprom_read_block(&ee, (const void *)CALIB_EE_ADDR, sizeof(ee));
+    calibrated = calib_valid(&ee);
+#ifdef ADAPT
+    eeprom_read_block(&learned, (const void *)ADAPT_EE_ADDR, sizeof(learned));
+    adapted = adapt_valid(&learned);
+#endif
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if(until)
+        for(i = 0; des_now() < until; ++i)
+            shifter_step();
+    else
+        for(i = 0; i < steps; ++i)
+            shifter_step();
+    if(*rx_text)
+    {
+        until = des_now() + 1000000;
+        des_schedule(des_now(), rx_event, 0);
+        for(; des_now() < until; ++i)
+            shifter_step();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    steps = i;
+
+    for(i = 0; i < TASKS; ++i)
+        late += sched_tasks[i].missed;
+
+    wall = (t1.tv_sec-t0.tv_sec) + (t1.tv_nsec-t0.tv_nsec)/1e9;
+    fprintf(stderr, "steps      %lu\n", steps);
+    fprintf(stderr, "virtual    %.3f s\n", des_now()/1e6);
+    fprintf(stderr, "wall       %.3f s\n", wall);
+    fprintf(stderr, "steps/s    %.0f\n", wall > 0 ? steps/wall : 0.0);
+    fprintf(stderr, "events     %llu\n",
+            (unsigned long long)des_events_run());
+    fprintf(stderr, "shifts     %u\n", shifts);
+    fprintf(stderr, "gear       %u (car %u)\n", gear_num(), plant.gear);
+    fprintf(stderr, "missed     %u\n", plant.missed);
+    fprintf(stderr, "distance   %.3f km\n", distance/1e9);
+    fprintf(stderr, "speed      %.1f km/h\n", plant_speed()*0.0036);
+    fprintf(stderr, "calib      %s\n", calibrated ? "eeprom" : "defaults");
+#ifdef ADAPT
+    // Learned cut/hold (ms) of each gear, shifting out of it
+    fprintf(stderr, "adapt      %s\n", adapted ? "eeprom" : "defaults");
+    fprintf(stderr, "timing up ");
+    for(i = 1; i < MAX_GEARS; ++i)
+        fprintf(stderr, " %u/%u", adapt_ign_ms(SOLEN_UP, i),
+                adapt_solen_ms(SOLEN_UP, i));
+    fprintf(stderr, "\ntiming dn ");
+    for(i = 2; i <= MAX_GEARS; ++i)
+        fprintf(stderr, " %u/%u", adapt_ign_ms(SOLEN_DN, i),
+                adapt_solen_ms(SOLEN_DN, i));
+    fprintf(stderr, "\n");
+#endif
+    fprintf(stderr, "latency    %u ms\n", shift_latency());
+    fprintf(stderr, "late tasks %u\n", late);
+    fprintf(stderr, "watchdog   %u\n", wdt_resets);
+    fprintf(stderr, "tx dropped %u\n", serial_tx_dropped);
+    fprintf(stderr, "rx dropped %u\n", serial_rx_dropped);
+    fprintf(stderr, "digest     %08x\n", digest);
+    if(rec)
+        fclose(rec);
+    if(eeprom_out)
+        save_eeprom(eeprom_out);
+    return 0;
+}
@@ -11,14 +11,23 @@
 #include <stdio.h>
 #include "SAE_AutoShifter.h"
 #include "serial.h"
+#include "telemetry.h"
+#include "shift.h"
+#include "btn_event.h"
+#include "calib.h"
+#include "adc.h"
+#include "plant.h"
+#include "prof.h"
+#include "sched.h"
+#include "bbox.h"
+#include "ram.h"
+#include "timer.h"
+#include "cmd.h"
+#include "config.h"
+#include "adapt.h"
 
 //#define F_CPU 16000000L
-///Uncomment #DEBUG to print out system information.
-#define DEBUG 1
-///Uncomment #SIMULATE in order to use the rpm regulator simulation
-#define SIMULATE 1
 
-uint8_t canPrint;   ///<DEBUG variable - print flag
 /**
  * @brief Initialize i/o ports and timer.
  *
@@ -36,13 +45,9 @@ uint8_t canPrint;   ///<DEBUG variable - print flag
  *  - Tachometer Input
  *      - #TACH_IP_DDR    => set #TACH_PIN as input
  *      - Enable external Interrupt 
- *  - Gas Pedal Input
- *      - Enable ADC
- *          - 128 Prescaler
- *          - AREF = AVCC
- *          - Left align result
- *          - Free Running mode */
-inline void io_init(void)
+ *  - Gas Pedal and Spare Analog Inputs
+ *      - adc_init()      => Timer0 triggered scan, see adc.h */
+static void io_init(void)
 {
     //Setup outputs
     //Solenoid output
@@ -53,7 +58,7 @@ inline void io_init(void)
     BOARD_DDR |= _BV(BOARD_LIGHT);
     BOARD_PORT &= ~_BV(BOARD_LIGHT);
 
-    init_usart(Baud9600);    
+    init_usart(SERIAL_BAUD);    
     
     //Setup inputs
     //User buttons
@@ -65,23 +70,19 @@ inline void io_init(void)
     //Ignition Interrupt
     ECU_DDR |= _BV(IGNITION_INT);
     ECU_PORT &= ~_BV(IGNITION_INT);
-    //#else
     //Tachometer input
+#ifdef SIMULATE
+    //Driven by the plant model; INT0 still fires on the output edges
+    ECU_DDR |= _BV(TACH_PIN);
+    ECU_PORT &= ~_BV(TACH_PIN);
+#else
     ECU_DDR &= ~_BV(TACH_PIN);
+#endif
     EICRA |= _BV(ISC01)|_BV(ISC00); //Interrupt0 Rising Edge
     EIMSK |= _BV(INT0);             //enable Interrupt0
-//#endif
    
-//#ifdef SIMULATE
-    //Gas Pedal input (ADC)
-    ADCSRA |= _BV(ADPS2)|_BV(ADPS1)|_BV(ADPS0); //select 128 prescaler
-    ADCSRA |= _BV(ADATE);
-    ADMUX |= _BV(REFS0);    //Set ADC reference to AVCC
-    ADMUX |= _BV(ADLAR);    //Left align result
-    ADMUX &= ~(_BV(MUX3)|_BV(MUX2)|_BV(MUX1)|_BV(MUX0));  //Select ADC0
-    ADCSRB &= ~(_BV(ADTS2)|_BV(ADTS1)|_BV(ADTS0)); //Select Free Running
-    ADCSRA |= _BV(ADEN);     //Enable ADC
-    ADCSRA |= _BV(ADIE);     //Enable ADC Interrupt
+    //Gas pedal and spare analog inputs
+    adc_init();
     sei();
 }
 
@@ -92,80 +93,254 @@ inline void io_init(void)
  *  - Configure Timer 0 for CTC (Clear Timer on Compare)
  *  - Prescaler set to #PRESCALER0 (16MHz/#PRESCALER0)
  *  - Fires every #TIMER0_FREQ Hz                   */
-inline void timer0_init(void)
+static void timer0_init(void)
 {
     TCCR0A |= _BV(WGM01);   // Configure Timer 0 for CTC mode
     TIMSK0 |= _BV(OCIE0A);  // Enable Output Compare interrupt
 
-    // OCR0A = 16M/64/1k-1 = 249 < 256
-    OCR0A = F_CPU/PRESCALER0/TIMER0_FREQ-1;
+    // OCR0A = 16M/64/1k-1 = 249, checked to fit in config.h
+    OCR0A = TIMER0_OCR;
 
-    TCCR0B |= _BV(CS01)|_BV(CS00);    // Start Timer0 at F_CPU/64
+    TCCR0B |= TIMER0_CS;    // Start Timer0 at F_CPU/PRESCALER0
 }
 
+static Timer wdt_timer;     ///<Kicks the watchdog
+
+#ifndef HOST
+void wdt_off(void) __attribute__((naked, used, section(".init3")));
+
 /**
- * @brief Initialize Timer 1.
+ * @brief Turn the watchdog off before the C runtime starts.
  *
- * Timer 1:
- *  - Configure Timer 1 for...
- *  - Prescaler set to #PRESCALER1 (16MHz/#PRESCALER1)
- *  - Fires every #TIMER1_FREQ Hz               */
-inline void timer1_init(void)
+ * After a watchdog reset it stays enabled at its shortest timeout, which
+ * would reset the part again before shifter_init() gets to it.
+ */
+void wdt_off(void)
 {
-    TCCR1B |= _BV(WGM12);   // Configure Timer 0 for CTC mode
-    TIMSK1 |= _BV(OCIE1A);  // Enable Output compare interrupt
+    MCUSR = 0;
+    wdt_disable();
+}
+#endif /* HOST */
 
-    // 0CR1A = 16M/256/1-1 = 62,499 < 65,536
-    OCR1A |= F_CPU/PRESCALER1/TIMER1_FREQ-1;
+/**
+ * @brief Timer: kick the watchdog every #WDT_KICK_MS.
+ *
+ * Kicked from the wheel, so the part resets when the main task stops
+ * running its timers, not just when it stops altogether.
+ */
+static void wdt_kick(void *arg)
+{
+    (void)arg;
+    wdt_reset();
+}
 
-    TCCR1B |= _BV(CS12);
+#ifdef TELEMETRY
+/**
+ * @brief Send a telemetry frame. #TASK_OUTPUT runs every #TLM_PERIOD_MS.
+ *
+ * Frames that do not fit in the transmit buffer are dropped; the sequence
+ * number still advances so the decoder sees the gap.
+ */
+static void send_telemetry(const Sensor_Snapshot *snap)
+{
+    static uint8_t seq = 0;
+    uint32_t now = millis();
+    uint8_t frame[TLM_FRAME_MAX];
+    Tlm_Sample s;
+
+    s.seq      = seq++;
+    s.ms       = (uint16_t)now;
+    s.mode     = mode;
+    s.gear     = gear_num();
+    s.rpms     = snap->rpms;
+    s.ave      = snap->ave;
+    s.throttle = snap->throttle;
+    s.adc      = snap->adc;
+    serial_write(frame, tlm_frame(&s, frame));
 }
+#endif /* TELEMETRY */
 
-/** 
- *  @brief   The main task for the autoshifter      */
-int main(void)
+/**
+ * @brief Handle one paddle event.
+ *
+ * Shifts happen on release, as before. The event time is passed on so the
+ * sequencer can measure paddle-to-solenoid latency.
+ *
+ *  - manual:    both paddles
+ *  - semi_man:  downshift paddle only, upshifts are automatic
+ *  - automated: paddles are ignored
+ */
+static void on_paddle(const Btn_Event *ev, const Sensor_Snapshot *snap)
+{
+    const Gear *target = shift_target();
+    uint16_t up = shiftmap_up(target->g_num, snap->adc);
+
+    if(ev->type != BTN_RELEASE)
+        return;
+
+    switch(mode)
+    {
+        case manual:
+            if(ev->pin == USHIFT_PIN)
+                shift_request(SOLEN_UP, ev->ms);
+            else if(ev->pin == DSHIFT_PIN && snap->median < up)
+                shift_request(SOLEN_DN, ev->ms);
+            break;
+        case semi_man:
+            if(ev->pin == DSHIFT_PIN && snap->ave < up)
+                shift_request(SOLEN_DN, ev->ms);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief #TASK_PADDLE: act on each queued paddle event.
+ */
+static void paddle_task(void)
+{
+    Sensor_Snapshot snap;
+    Btn_Event ev;
+
+    sensor_snapshot(&snap);
+    while(btn_event_pop(&ev))
+        on_paddle(&ev, &snap);
+}
+
+/**
+ * @brief #TASK_SHIFT: automatic shift logic for the current #mode.
+ *
+ * Compares the rpm against the shift map of the gear the box is heading
+ * for, upshifting ahead of the map by shift_lead_rpm(). The lead never
+ * reaches within #SHIFT_LEAD_MARGIN of the gear's downshift rpm, and no
+ * upshift is made below it, however large the slope or @c calib.lead_max.
+ * Nothing is asked while shift_busy(), as the rpm is still that of the
+ * gear being left. Posted by every new rpm sample, and run every
+ * #SCHED_SHIFT_MS so throttle changes are acted on with the engine stalled
+ * too.
+ */
+static void shift_task(void)
+{
+    uint16_t now = (uint16_t)millis();
+    Sensor_Snapshot snap;
+    const Gear *target;
+    uint16_t up, down, lead;
+
+    PROF_BEGIN(PROF_LOGIC);
+    sensor_snapshot(&snap);
+    target = shift_target();
+    up = shiftmap_up(target->g_num, snap.adc);
+    down = shiftmap_down(target->g_num, snap.adc);
+    lead = shift_lead_rpm(target->g_num, snap.slope,
+                          (uint16_t)((micros() - snap.us)/1000));
+    // The lead may bring the upshift down to the gear's lower bound only
+    if(up < down + SHIFT_LEAD_MARGIN)
+        lead = 0;
+    else if(lead > up - down - SHIFT_LEAD_MARGIN)
+        lead = up - down - SHIFT_LEAD_MARGIN;
+    switch(mode)
+    {
+        case semi_man:
+        case automated:
+            // The rpm is of the gear being left until the shift is done
+            if(shift_busy())
+                break;
+            // Upshift, early enough to be through at the mapped rpm
+            if(snap.median >= down && (uint32_t)snap.median + lead >= up)
+                shift_request(SOLEN_UP, now);
+            // Downshift
+            else if(mode == automated && snap.median < down)
+                shift_request(SOLEN_DN, now);
+            break;
+        default:
+            //Manual: paddles only
+            break;
+    }
+    PROF_END(PROF_LOGIC);
+}
+
+/**
+ * @brief #TASK_OUTPUT: report the state.
+ *
+ * A telemetry frame every #TLM_PERIOD_MS, or the text printout every
+ * #SCHED_PRINT_MS.
+ */
+static void output_task(void)
+{
+    Sensor_Snapshot snap;
+
+    PROF_BEGIN(PROF_OUTPUT);
+    sensor_snapshot(&snap);
+#ifdef TELEMETRY
+    send_telemetry(&snap);
+#else
+    //printf("cur pos = %d\n\r",throttle_pos);
+    //printf("current ADC = %d\n\r",cur_adc);
+    printf("Current mode = %d\n\r", mode);
+    printf("Current gear = %d\n\r", gear_num());
+    printf("Current rpms = %d\n\r",snap.rpms);
+    //printf("Ave rpms = %d\r\r",average_rpms());
+#endif /* TELEMETRY */
+    PROF_END(PROF_OUTPUT);
+}
+
+/**
+ * @brief #TASK_HOUSEKEEPING: heartbeat, stack guard, serial commands, see
+ * cmd.h, and saving the learned shift timings, see adapt.h.
+ *
+ * The board light is on for the first half of every second while the
+ * main task is alive.
+ */
+static void housekeeping_task(void)
+{
+    int c = cmd_poll();
+
+    if((uint16_t)millis() % 1000 < 500)
+        BOARD_PORT |= _BV(BOARD_LIGHT);
+    else
+        BOARD_PORT &= ~_BV(BOARD_LIGHT);
+#ifdef PROFILE
+    prof_command(c);
+#endif
+#ifdef BLACKBOX
+    bbox_command(c);
+#endif
+#ifdef RAMCHECK
+    ram_check();
+    ram_command(c);
+#endif
+    (void)c;
+    adapt_save();
+}
+
+/**
+ *  @brief   Initialize the hardware and the gearbox.
+ *
+ *  Everything the main task needs before its first iteration, the task
+ *  table included. */
+void shifter_init(void)
 {   
+    uint8_t calibrated = calib_load();
+    uint8_t learned = adapt_load();
+
+    tach_init();
+#ifdef SIMULATE
+    plant_init();
+#endif
+#ifdef PROFILE
+    prof_init();
+#endif
+#ifdef BLACKBOX
+    bbox_init();
+#endif
     timer0_init();
-    timer1_init();
     io_init();
    
-    //Create and initialize gears
-    Gear g1,g2,g3,g4,g5;
-    //Gear_Const(Gear *this, uint8_t num, uint8_t lower, uint8_t upper,
-    //           Gear *p, Gear* n)
-    
-    Gear_Construct(&g1,1,0,100,50,0,&g2);
-    uint16_t inc1[MAX_GEARS] = {20,30,40,100,200};
-    uint16_t dec1[MAX_GEARS] = {200,100,30,20,10};
-    Gear_IncreaseLevels(&g1,inc1);
-    Gear_DecreaseLevels(&g1,dec1);
-
-    Gear_Construct(&g2,2,20,200,150,&g1,&g3);
-    uint16_t inc2[MAX_GEARS] = {20,40,60,90,160};
-    uint16_t dec2[MAX_GEARS] = {400,90,40,20,10};
-    Gear_IncreaseLevels(&g2,inc2);
-    Gear_DecreaseLevels(&g2,dec2);
-   
-    Gear_Construct(&g3,3,120,300,250,&g2,&g4);
-    uint16_t inc3[MAX_GEARS] = {40,60,80,100,120};
-    uint16_t dec3[MAX_GEARS] = {140,80,50,30,10};
-    Gear_IncreaseLevels(&g3,inc3);
-    Gear_DecreaseLevels(&g3,dec3);
-    
-    Gear_Construct(&g4,4,200,400,350,&g3,&g5);
-    uint16_t inc4[MAX_GEARS] = {20,40,60,80,100};
-    uint16_t dec4[MAX_GEARS] = {100,60,40,20,10};
-    Gear_IncreaseLevels(&g4,inc4);
-    Gear_DecreaseLevels(&g4,dec4);
-    
-    Gear_Construct(&g5,5,300,500,450,&g4,0);
-    uint16_t inc5[MAX_GEARS] = {20,30,40,50,60};
-    uint16_t dec5[MAX_GEARS] = {50,40,30,20,10};
-    Gear_IncreaseLevels(&g5,inc5);
-    Gear_DecreaseLevels(&g5,dec5);
-    
-    gear_ = &g1;
+    gear_ = &gears[0];
+    shift_init();
 
+#ifndef TELEMETRY
 #ifdef DEBUG
     puts("DEBUG is on.\r\n");
 #endif
@@ -173,100 +348,62 @@ int main(void)
 #ifdef SIMULATE
     puts("SIMULATE is on.\r\n");
 #endif
+    puts(calibrated ? "Calibration loaded.\r\n" :
+                      "No calibration, using defaults.\r\n");
+    if(learned)
+        puts("Learned shift timings loaded.\r\n");
     printf("\rStarting main task...\r\r");
+#else
+    (void)calibrated;
+    (void)learned;
+#endif /* TELEMETRY */
     delay_ms(200);
-    ADCSRA |= _BV(ADSC);     //Start ADC Conversion
     //sei();
 
+    // Every timer starts from here, so the wheel has no boot time to catch up
+    timer_init();
+    sched_init();
+    sched_add(TASK_TIMER, timer_run, 0, SCHED_TIMER_DL);
+    sched_add(TASK_PADDLE, paddle_task, 0, SCHED_PADDLE_DL);
+    sched_add(TASK_SHIFT, shift_task, SCHED_SHIFT_MS, SCHED_SHIFT_DL);
+#ifdef TELEMETRY
+    sched_add(TASK_OUTPUT, output_task, TLM_PERIOD_MS, TLM_PERIOD_MS);
+#else
+    sched_add(TASK_OUTPUT, output_task, SCHED_PRINT_MS, SCHED_PRINT_DL);
+#endif
+    sched_add(TASK_HOUSEKEEPING, housekeeping_task, SCHED_HOUSEKEEPING_MS,
+              SCHED_HOUSEKEEPING_MS);
+    inputs_start();
+
+    timer_start(&wdt_timer, WDT_KICK_MS, WDT_KICK_MS, wdt_kick, 0);
+    wdt_enable(WDT_TIMEOUT);
+}
+
+/**
+ *  @brief   One pass of the main task.
+ *
+ *  Runs the released tasks, see sched.h, or sleeps until an interrupt
+ *  when there are none. */
+void shifter_step(void)
+{
+#ifdef PROFILE
+    prof_mark();
+#endif
+    sched_run();
+}
+
+/** 
+ *  @brief   The main task for the autoshifter      */
+#ifndef HOST
+int main(void)
+{
+    shifter_init();
+
     //Main task
     for(;;)
-    {
-        switch(mode)
-        {
-            case manual:         //Manual
-                //If up_shift is pressed and released...
-                if(onRelease(&up_shift))
-                {
-                    if(gear_->next != 0)
-                    {
-                        shift(SOLEN_UP);
-                        gear_ = gear_->next;
-                    }
-                }
-
-                //If dn_shift is pressed and released...
-                if(onRelease(&dn_shift))
-                {
-                    if(gear_->prev != 0 && tach.rpms < gear_upper())
-                    {
-                        shift(SOLEN_DN);
-                        gear_ = gear_->prev;
-                    }
-                }
-                break;
-            case semi_man:
-                // Upshift 
-                if(tach.rpms >= gear_upper())
-                {
-                    if(gear_->next != 0)
-                    {
-                        shift(SOLEN_UP);
-                        gear_ = gear_->next;
-                    }
-                }
-                // Downshift
-                if(onRelease(&dn_shift))
-                {
-                    if(gear_->prev != 0 && tach.ave < gear_upper())
-                    {
-                        shift(SOLEN_DN);
-                        gear_ = gear_->prev;
-                    }
-                }
-                break;
-            case automated:
-                // Upshift
-                if(tach.rpms >= gear_upper())
-                {
-                    if(gear_->next != 0)
-                    {
-                        shift(SOLEN_UP);
-                        gear_ = gear_->next;
-                    }
-                }
-                // Downshift
-                else if(tach.rpms < gear_lower())
-                {
-                    if(gear_->prev != 0)
-                    {
-                        shift(SOLEN_DN);
-                        gear_ = gear_->prev;
-                    }
-                }
-                break;
-            default:
-                //Should not get here...
-                break;
-        }
-        
-        update_ave_rpms();
-
-//#ifdef DEBUG
-        if(canPrint)
-        {
-            //printf("cur pos = %d\n\r",throttle_pos);
-            //printf("current ADC = %d\n\r",cur_adc);
-            printf("Current mode = %d\n\r", mode);
-            printf("Current gear = %d\n\r", gear_num());
-            printf("Current rpms = %d\n\r",cur_rpms());
-            //printf("Ave rpms = %d\r\r",average_rpms());
-
-            canPrint = 0;
-        }
-//#endif
-       //Give'em a break.
-        delay_ms(1);
-    }
+        shifter_step();
+
     // Should never get here
     return 0;
 }
+#endif /* HOST */
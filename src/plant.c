@@ -0,0 +1,164 @@
+/**
+ *  @file
+ *  @brief Engine and vehicle plant model.
+ *
+ *  @date    10/18/2026
+ */
+#include "plant.h"
+
+#define TORQUE_SHIFT    10  ///<Torque curve breakpoints every 1024 rpm
+#define TORQUE_POINTS   13
+///Free engine acceleration per ms and Nm/10, in 1/16 rpm (16 fraction bits)
+#define REV_K           (10013320L/PLANT_INERTIA)
+///2^24/mass, for the car alone when no gear is locked to the engine
+#define INV_M_CAR       ((1UL << 24)/PLANT_MASS_KG)
+
+/// Full throttle torque (Nm/10) at 0, 1024, ... 12288 rpm
+static const int16_t torque[TORQUE_POINTS] PROGMEM =
+    {200, 250, 300, 350, 400, 430, 460, 500, 540, 570, 580, 560, 500};
+
+/// Overall ratio of each gear, primary x gear x final drive (8 fraction bits)
+static const uint16_t ratio[MAX_GEARS] PROGMEM =
+    {4116, 2991, 2487, 2175, 1947};
+
+Plant plant;
+
+/**
+ * @brief Engine torque (Nm/10) at @c rpm and throttle @c tps.
+ */
+static int16_t engine_torque(uint16_t rpm, uint8_t tps)
+{
+    uint8_t i = rpm >> TORQUE_SHIFT;
+    int16_t t0, t1, wot;
+
+    if(i >= TORQUE_POINTS-1)
+        i = TORQUE_POINTS-2;
+    t0 = pgm_read_word(&torque[i]);
+    t1 = pgm_read_word(&torque[i+1]);
+    wot = t0 + (int32_t)(t1 - t0)*(rpm - ((uint16_t)i << TORQUE_SHIFT))
+               /(1 << TORQUE_SHIFT);
+
+    // Friction: 3 Nm plus 1 Nm per 2560 rpm
+    return ((int32_t)wot*tps >> 8) - 30 - (rpm >> 8);
+}
+
+/**
+ * @brief Work out the constants of the engaged gear.
+ */
+static void engage(void)
+{
+    uint32_t g = pgm_read_word(&ratio[plant.gear-1]);
+    uint32_t a;     // gear ratio over wheel radius (1/m), x10
+    uint32_t m;
+
+    plant.kf = g*PLANT_EFF*256/PLANT_WHEEL_MM;
+    plant.kr = g*15360/(PLANT_WHEEL_MM*628UL/100);
+
+    // The engine inertia seen at the wheel adds to the mass
+    a = g*10000/(256UL*PLANT_WHEEL_MM);
+    m = PLANT_MASS_KG + PLANT_INERTIA*a*a/1000000UL;
+    plant.inv_m = (1UL << 24)/m;
+}
+
+void plant_init(void)
+{
+    plant.gear = 1;
+    plant.neutral = 0;
+    plant.missed = 0;
+    plant.speed = 0;
+    plant.rpm = PLANT_IDLE_RPM;
+    plant.rpm_q = (uint32_t)PLANT_IDLE_RPM << 4;
+    plant.solen = 0;
+    plant.cut = 0;
+    plant.cut_ms = 0;
+    plant.solen_ms = 0;
+    engage();
+}
+
+/**
+ * @brief Follow the solenoids: neutral while one is on, the next gear
+ * when it is released.
+ */
+static void shift(uint8_t outputs)
+{
+    uint8_t solen = outputs & (PLANT_SOLEN_UP|PLANT_SOLEN_DN);
+
+    if(!(outputs & PLANT_IGN_CUT))
+        plant.cut_ms = 0;
+    else if(plant.cut_ms < 0xFF)
+        ++plant.cut_ms;
+
+    if(solen & ~plant.solen)
+    {
+        plant.neutral = 1;
+        plant.cut = plant.cut_ms >= PLANT_CUT_MS;
+        plant.solen_ms = 0;
+    }else if(plant.solen & ~solen)
+    {
+        plant.neutral = 0;
+        // Dogs under load will not let go, a short pulse falls back
+        if(plant.solen_ms < PLANT_SOLEN_MS ||
+           (plant.solen & PLANT_SOLEN_UP && !plant.cut))
+            ++plant.missed;
+        else if(plant.solen & PLANT_SOLEN_UP)
+        {
+            if(plant.gear < MAX_GEARS)
+                ++plant.gear;
+        }else if(plant.gear > 1)
+            --plant.gear;
+        engage();
+    }
+    if(solen && plant.solen_ms < 0xFF)
+        ++plant.solen_ms;
+    plant.solen = solen;
+}
+
+void plant_step(uint8_t tps, uint8_t outputs)
+{
+    uint16_t v = plant.speed >> 8;
+    int16_t t;
+    int32_t f = 0;
+    uint32_t inv_m = INV_M_CAR;
+
+    shift(outputs);
+
+    if((outputs & PLANT_IGN_CUT) || plant.rpm >= PLANT_LIMIT_RPM)
+        tps = 0;
+    t = engine_torque(plant.rpm, tps);
+
+    if(plant.neutral)
+    {
+        // Engine spins freely: rpm/ms = torque/inertia*60/2pi
+        plant.rpm_q += (int32_t)t*REV_K >> 16;
+        if(plant.rpm_q < (uint32_t)PLANT_IDLE_RPM << 4)
+            plant.rpm_q = (uint32_t)PLANT_IDLE_RPM << 4;
+    }else
+    {
+        uint32_t locked = (uint32_t)v*plant.kr >> 16;
+        uint16_t launch = PLANT_IDLE_RPM +
+                    ((uint32_t)(PLANT_LAUNCH_RPM-PLANT_IDLE_RPM)*tps >> 8);
+
+        if(locked < launch)
+        {
+            // Clutch slipping: it passes drive but not engine braking
+            plant.rpm_q = (uint32_t)launch << 4;
+            if(t > 0)
+                f = (int32_t)t*(int32_t)plant.kf >> 16;
+        }else
+        {
+            plant.rpm_q = locked << 4;
+            f = (int32_t)t*(int32_t)plant.kf >> 16;
+            inv_m = plant.inv_m;
+        }
+    }
+    plant.rpm = plant.rpm_q >> 4;
+
+    // Drag: PLANT_DRAG_N*(v/10 m/s)^2, 687/2^20 ~ 2^16/10^8
+    f -= ((uint32_t)v*v >> 16)*PLANT_DRAG_N*687 >> 20;
+    if(v)
+        f -= PLANT_ROLL_N;
+
+    plant.speed += f*(int32_t)inv_m >> 16;
+    if(plant.speed < 0)
+        plant.speed = 0;
+}
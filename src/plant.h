@@ -0,0 +1,97 @@
+/** @file
+ * @brief Engine and vehicle plant model.
+ *
+ * A point-mass car driven through a gearbox by an engine with a full
+ * throttle torque curve, stepped once per millisecond:
+ *  - engine torque is the curve scaled by throttle, less friction; with the
+ *    ignition cut or at the rev limiter only the friction remains
+ *  - in gear the engine is locked to the wheels through the gear and final
+ *    drive ratios, and its inertia adds to the vehicle mass
+ *  - below the launch speed the clutch slips, holding the engine at a
+ *    throttle dependent launch rpm
+ *  - aerodynamic drag and rolling resistance slow the car
+ *  - an energized solenoid puts the box in neutral, where the engine spins
+ *    freely; the new gear engages when the solenoid is released. An upshift
+ *    whose solenoid fires before the ignition has been cut for
+ *    #PLANT_CUT_MS, or any shift whose solenoid is released before
+ *    #PLANT_SOLEN_MS, does not go through and the old gear engages again
+ *
+ * Everything is fixed point with no division in plant_step(), so the same
+ * model runs in the #TIMER0_FREQ interrupt of a #SIMULATE build and in the
+ * host driver.
+ *
+ * @date    10/18/2026
+ */
+#ifndef PLANT_H
+#define PLANT_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+/** @name Plant Defines */
+//@{
+#define PLANT_MASS_KG       300     ///<Car and driver (kg)
+#define PLANT_WHEEL_MM      260     ///<Rolling radius of the driven wheel (mm)
+#define PLANT_INERTIA       400     ///<Engine and clutch inertia (kg cm^2)
+#define PLANT_EFF           90      ///<Drivetrain efficiency (%)
+#define PLANT_DRAG_N        72      ///<Aerodynamic drag at 10 m/s (N)
+#define PLANT_ROLL_N        45      ///<Rolling resistance (N)
+#define PLANT_IDLE_RPM      2000    ///<Idle speed
+#define PLANT_LAUNCH_RPM    6000    ///<Clutch slip speed at full throttle
+#define PLANT_LIMIT_RPM     11800   ///<Rev limiter
+#define PLANT_CUT_MS        4       ///<Cut needed before an upshift (ms)
+#define PLANT_SOLEN_MS      12      ///<Solenoid travel to the next gear (ms)
+//@}
+
+/** @name Plant Outputs
+ *  Bits of the @c outputs argument of plant_step().
+ */
+//@{
+#define PLANT_IGN_CUT       0x01    ///<Ignition cut
+#define PLANT_SOLEN_UP      0x02    ///<Upshift solenoid energized
+#define PLANT_SOLEN_DN      0x04    ///<Downshift solenoid energized
+//@}
+
+/// Model state.
+typedef struct
+{
+    uint16_t rpm;       ///< Engine speed
+    uint8_t  gear;      ///< Engaged gear, 1 to #MAX_GEARS
+    uint8_t  neutral;   ///< A solenoid is energized, no gear engaged
+    uint16_t missed;    ///< Shifts that did not go through
+    int32_t  speed;     ///< Vehicle speed (mm/s, 8 fraction bits)
+    uint32_t rpm_q;     ///< Engine speed (4 fraction bits)
+    uint8_t  solen;     ///< Solenoid outputs at the last step
+    uint8_t  cut;       ///< Ignition was cut long enough when it fired
+    uint8_t  cut_ms;    ///< Time the ignition has been cut (ms)
+    uint8_t  solen_ms;  ///< Time the solenoid has been on (ms)
+    uint32_t kf;        ///< Torque (Nm/10) to wheel force (N), 16 fraction bits
+    uint32_t kr;        ///< Speed (mm/s) to engine rpm, 16 fraction bits
+    uint32_t inv_m;     ///< 1/effective mass, 24 fraction bits
+} Plant;
+
+extern Plant plant;     ///<The simulated car
+
+/**
+ * @brief Stop the car in first gear with the engine idling.
+ */
+void plant_init(void);
+
+/**
+ * @brief Advance the model by one millisecond.
+ *
+ * @param   tps     throttle, 0 to 255
+ * @param   outputs firmware outputs, #PLANT_IGN_CUT, #PLANT_SOLEN_UP and
+ *                  #PLANT_SOLEN_DN
+ */
+void plant_step(uint8_t tps, uint8_t outputs);
+
+/**
+ * @return vehicle speed in mm/s
+ */
+static inline uint16_t plant_speed(void)
+{
+    return plant.speed >> 8;
+}
+
+#endif /* PLANT_H */
@@ -0,0 +1,183 @@
+/**
+ *  @file
+ *  @brief ISR execution time and main loop jitter profiling.
+ *
+ *  @date    10/18/2026
+ */
+#include <string.h>
+#include "prof.h"
+#include "serial.h"
+#include "telemetry.h"
+
+#ifdef PROFILE
+
+#define REPORT_LINE 56      ///<Longest report line, fits the transmit buffer
+#ifdef TELEMETRY
+#define REPORT_ROOM TLM_FRAME_MAX   ///<Left free for the next frame
+#else
+#define REPORT_ROOM 0
+#endif
+
+Prof_Stat prof[PROF_IDS];
+
+/// Every pin belongs to an ISR
+typedef char prof_pins_check[PROF_PINS <= PROF_ISRS ? 1 : -1];
+
+/// Bucket shift of each #Prof_Id
+static const uint8_t shift[PROF_IDS] PROGMEM =
+{
+    PROF_ISR_SHIFT, PROF_ISR_SHIFT, PROF_ISR_SHIFT, PROF_ISR_SHIFT,
+    PROF_ISR_SHIFT, PROF_LOOP_SHIFT, PROF_PHASE_SHIFT, PROF_PHASE_SHIFT,
+    PROF_PHASE_SHIFT
+};
+
+static const char name[PROF_IDS][7] PROGMEM =
+    {"timer0", "adc", "int0", "rx", "udre", "loop", "timers", "logic",
+     "output"};
+
+static uint32_t  last_mark; ///<micros() at the last prof_mark()
+static uint8_t   marked;    ///<prof_mark() has run
+static uint8_t   line;      ///<Next report line, 0 when idle
+static Prof_Stat shown;     ///<Copy being reported, so its lines agree
+
+/**
+ * @brief Clear the counters of every #Prof_Id.
+ */
+static void prof_reset(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    for(uint8_t i = 0; i < PROF_IDS; ++i)
+    {
+        memset(&prof[i], 0, sizeof(prof[i]));
+        prof[i].min = 0xFFFF;
+    }
+    SREG = sreg;
+}
+
+void prof_init(void)
+{
+    // Timer2 free-running at F_CPU/8, no interrupts
+    TCCR2A = 0;
+    TCCR2B = _BV(CS21);
+#ifdef PROF_GPIO
+    PROF_DDR |= ((1 << PROF_PINS)-1) << PROF_PIN0;
+    PROF_PORT &= ~(((1 << PROF_PINS)-1) << PROF_PIN0);
+    PROF_LOOP_DDR |= _BV(PROF_LOOP_PIN);
+#endif
+    prof_reset();
+}
+
+void prof_record(uint8_t id, uint16_t v)
+{
+    Prof_Stat *s = &prof[id];
+    uint16_t b = v >> pgm_read_byte(&shift[id]);
+    uint8_t i = 0;
+
+    // Bucket: bit length of the scaled value
+    while(b && i < PROF_BUCKETS-1)
+    {
+        b >>= 1;
+        ++i;
+    }
+    if(s->hist[i] != 0xFFFF)
+        ++s->hist[i];
+    ++s->count;
+    if(v < s->min)
+        s->min = v;
+    if(v > s->max)
+        s->max = v;
+}
+
+void prof_read(uint8_t id, Prof_Stat *s)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    *s = prof[id];
+    SREG = sreg;
+}
+
+void prof_mark(void)
+{
+    uint32_t now = micros();
+    uint32_t dt = now - last_mark;
+
+    last_mark = now;
+    // The first pass only starts the clock
+    if(marked)
+        prof_record(PROF_LOOP, dt > 0xFFFF ? 0xFFFF : dt);
+    marked = 1;
+#ifdef PROF_GPIO
+    PROF_LOOP_PORT ^= _BV(PROF_LOOP_PIN);
+#endif
+}
+
+/**
+ * @brief Format report line @c n (from 1) into @c buf.
+ *
+ * Line 1 is the header; then every #Prof_Id has a summary line and a
+ * histogram line. Returns the length, 0 past the last line.
+ */
+static uint8_t report_line(uint8_t n, char *buf)
+{
+    char id[sizeof(name[0])];
+    uint8_t i = (n-2)/2;
+    uint8_t len = 0;
+
+    if(n == 1)
+    {
+        len = serial_fmt_str(buf, 0, "prof: isr ");
+        len = serial_fmt_u(buf, len, PROF_ISR_NS);
+        len = serial_fmt_str(buf, len, " ns, loop us");
+    }else if(i >= PROF_IDS)
+        return 0;
+    else if(n & 1)
+    {
+        for(uint8_t b = 0; b < PROF_BUCKETS; ++b)
+        {
+            buf[len++] = ' ';
+            len = serial_fmt_u(buf, len, shown.hist[b]);
+        }
+    }else
+    {
+        memcpy_P(id, name[i], sizeof(id));
+        prof_read(i, &shown);
+        len = serial_fmt_str(buf, 0, id);
+        len = serial_fmt_str(buf, len, " n ");
+        len = serial_fmt_ul(buf, len, shown.count);
+        len = serial_fmt_str(buf, len, " min ");
+        len = serial_fmt_u(buf, len, shown.count ? shown.min : 0);
+        len = serial_fmt_str(buf, len, " max ");
+        len = serial_fmt_u(buf, len, shown.max);
+    }
+    len = serial_fmt_str(buf, len, "\r\n");
+#ifdef TELEMETRY
+    // Ends a block the decoder drops as bad; the next frame is untouched
+    buf[len++] = TLM_DELIM;
+#endif
+    return len;
+}
+
+void prof_command(int c)
+{
+    char buf[REPORT_LINE+1];
+    uint8_t len;
+
+    if(c == 'p' && !line)
+        line = 1;
+    else if(c == 'r')
+        prof_reset();
+
+    if(!line)
+        return;
+    len = report_line(line, buf);
+    if(!len)
+        line = 0;
+    // Otherwise try again next pass
+    else if(serial_write_room(buf, len, REPORT_ROOM))
+        ++line;
+}
+
+#endif /* PROFILE */
@@ -0,0 +1,163 @@
+/** @file
+ * @brief ISR execution time and main loop jitter profiling.
+ *
+ * Built only with #PROFILE. Timer2 free-runs at F_CPU/8 as the time base
+ * of the ISRs: PROF_ISR_BEGIN() reads it on entry and PROF_ISR_END() on
+ * exit, so each ISR is timed to #PROF_ISR_NS ns. An ISR longer than 256 counts
+ * (128 us) wraps and reads short, but it is already far over budget. The
+ * main loop runs for milliseconds and is timed against micros() instead:
+ * prof_mark() records the period between loop passes and PROF_BEGIN() and
+ * PROF_END() around a phase record the time it took, ISRs included.
+ *
+ * Every #Prof_Id keeps its count, minimum, maximum and a histogram of
+ * #PROF_BUCKETS power of two buckets. Bucket 0 counts values below
+ * 2^shift units, bucket @c b values below 2^(shift+b) and the last bucket
+ * everything above, where the shift is #PROF_ISR_SHIFT, #PROF_LOOP_SHIFT or
+ * #PROF_PHASE_SHIFT.
+ *
+ * prof_command() handles serial commands: @c 'p' sends a report,
+ * one line per main loop pass as the transmit buffer has room, and @c 'r'
+ * clears the counters. With #TELEMETRY each report line ends in the frame
+ * delimiter, so the decoder drops it as one bad block, and is held back
+ * until a frame still fits behind it.
+ *
+ * With #PROF_GPIO the first #PROF_PINS ISRs also hold their pin on
+ * #PROF_PORT high while they run, and #PROF_LOOP_PIN toggles every loop
+ * pass, for a logic analyzer. The serial ISRs have no pin left to them.
+ *
+ * Without #PROFILE the macros are empty and nothing is compiled in.
+ *
+ * @date    10/18/2026
+ */
+#ifndef PROF_H
+#define PROF_H 1
+
+#include <stdint.h>
+#include "SAE_AutoShifter.h"
+
+/** @name Profiling Defines */
+//@{
+#define PROF_BUCKETS        8       ///<Histogram buckets per #Prof_Id
+#define PROF_ISR_NS         500     ///<Timer2 resolution (ns per count)
+#define PROF_ISR_SHIFT      0       ///<ISR buckets: <1, <2, <4 ... counts
+#define PROF_LOOP_SHIFT     7       ///<Loop buckets: <128, <256 ... us
+#define PROF_PHASE_SHIFT    4       ///<Phase buckets: <16, <32 ... us
+#define PROF_DDR            DDRC    ///<ISR pin DDR
+#define PROF_PORT           PORTC   ///<ISR pin Port
+#define PROF_PIN0           PC3     ///<Pin of the first ISR, the rest follow
+#define PROF_PINS           3       ///<ISRs with a pin, PC3-PC5
+#define PROF_LOOP_DDR       DDRB    ///<Loop pin DDR
+#define PROF_LOOP_PORT      PORTB   ///<Loop pin Port
+#define PROF_LOOP_PIN       PB0     ///<Toggles every main loop pass
+//@}
+
+/// What is profiled. The ISRs come first, those with a pin leading.
+typedef enum
+{
+    PROF_TIMER0,        ///< ISR(TIMER0_COMPA_vect)
+    PROF_ADC,           ///< ISR(ADC_vect)
+    PROF_INT0,          ///< ISR(INT0_vect), the tach edge
+    PROF_USART_RX,      ///< ISR(USART_RX_vect)
+    PROF_USART_UDRE,    ///< ISR(USART_UDRE_vect)
+    PROF_ISRS,
+    PROF_LOOP = PROF_ISRS,  ///< Time between scheduler passes
+    PROF_TIMERS,        ///< #TASK_TIMER, every timer callback due
+    PROF_LOGIC,         ///< #TASK_SHIFT
+    PROF_OUTPUT,        ///< #TASK_OUTPUT
+    PROF_IDS
+} Prof_Id;
+
+/// Statistics of one #Prof_Id.
+typedef struct
+{
+    uint32_t count;                 ///< Samples recorded
+    uint16_t min;                   ///< Shortest
+    uint16_t max;                   ///< Longest
+    uint16_t hist[PROF_BUCKETS];    ///< Histogram, saturating
+} Prof_Stat;
+
+#ifdef PROFILE
+
+extern Prof_Stat prof[PROF_IDS];    ///<Written by ISRs, see prof_read()
+
+/**
+ * @brief Start Timer2 and the profiling pins, and clear the counters.
+ */
+void prof_init(void);
+
+/**
+ * @brief Add a sample to @c id.
+ *
+ * Interrupts must be disabled for an ISR's @c id, as they are in the ISR.
+ */
+void prof_record(uint8_t id, uint16_t v);
+
+/**
+ * @brief Copy the statistics of @c id with interrupts disabled.
+ */
+void prof_read(uint8_t id, Prof_Stat *s);
+
+/**
+ * @brief Start of a main loop pass: record the period since the last one.
+ */
+void prof_mark(void);
+
+/**
+ * @brief Handle serial command @c c and send the next line of a report.
+ *
+ * Call once per main loop pass with the received byte, or -1. Never waits
+ * for the line.
+ */
+void prof_command(int c);
+
+/// Time of entry to an ISR (Timer2 counts).
+static inline uint8_t prof_isr_enter(uint8_t id)
+{
+#ifdef PROF_GPIO
+    if(id < PROF_PINS)
+        PROF_PORT |= _BV(PROF_PIN0 + id);
+#endif
+    return TCNT2;
+}
+
+/// Record the time since prof_isr_enter().
+static inline void prof_isr_exit(uint8_t id, uint8_t t0)
+{
+    uint8_t dt = TCNT2 - t0;
+
+#ifdef PROF_GPIO
+    if(id < PROF_PINS)
+        PROF_PORT &= ~_BV(PROF_PIN0 + id);
+#endif
+    prof_record(id, dt);
+}
+
+/// Record the time since @c t0 (us).
+static inline void prof_phase_end(uint8_t id, uint32_t t0)
+{
+    uint32_t dt = micros() - t0;
+
+    prof_record(id, dt > 0xFFFF ? 0xFFFF : dt);
+}
+
+/**
+ * @name Profiling Points
+ * Open and close a profiled ISR or phase in the same block.
+ */
+//@{
+#define PROF_ISR_BEGIN(id)  uint8_t prof_##id##_ = prof_isr_enter(id)
+#define PROF_ISR_END(id)    prof_isr_exit(id, prof_##id##_)
+#define PROF_BEGIN(id)      uint32_t prof_##id##_ = micros()
+#define PROF_END(id)        prof_phase_end(id, prof_##id##_)
+//@}
+
+#else
+
+#define PROF_ISR_BEGIN(id)
+#define PROF_ISR_END(id)
+#define PROF_BEGIN(id)
+#define PROF_END(id)
+
+#endif /* PROFILE */
+
+#endif /* PROF_H */
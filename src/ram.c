@@ -0,0 +1,146 @@
+/**
+ *  @file
+ *  @brief SRAM and stack usage.
+ *
+ *  @date    10/18/2026
+ */
+#include "ram.h"
+#include "serial.h"
+#include "telemetry.h"
+#include "bbox.h"
+
+#ifdef RAMCHECK
+
+#define REPORT_LINE 48      ///<Longest report line
+#ifdef TELEMETRY
+#define REPORT_ROOM TLM_FRAME_MAX   ///<Left free for the next frame
+#else
+#define REPORT_ROOM 0
+#endif
+
+#ifndef HOST
+// Linker and allocator symbols, see avr-libc's malloc documentation
+extern uint8_t __data_start;    ///<Start of .data, the bottom of SRAM used
+extern uint8_t __heap_start;    ///<End of .bss, the start of the heap
+extern uint8_t __stack;         ///<Top of SRAM
+extern char    *__brkval;       ///<End of the heap, 0 before any malloc()
+
+void ram_paint(void) __attribute__((naked, used, section(".init1")));
+
+/**
+ * @brief Paint the RAM from the end of the static data to the top.
+ *
+ * Runs from .init1, before the stack pointer and r1 are set up, so it
+ * touches no stack and only the registers it loads itself.
+ */
+void ram_paint(void)
+{
+    __asm__ volatile(
+        "    ldi r30, lo8(__heap_start)\n"
+        "    ldi r31, hi8(__heap_start)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(__stack)\n"
+        "    rjmp 2f\n"
+        "1:  st Z+, r24\n"
+        "2:  cpi r30, lo8(__stack)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :: "M" (RAM_PAINT));
+}
+
+/**
+ * @return the lowest address the stack may grow down to
+ */
+static uint8_t *gap_start(void)
+{
+    return __brkval ? (uint8_t *)__brkval : &__heap_start;
+}
+
+uint16_t ram_static(void)
+{
+    return &__heap_start - &__data_start;
+}
+
+uint16_t ram_free(void)
+{
+    return (uint8_t *)SP - gap_start();
+}
+
+uint16_t ram_min_free(void)
+{
+    const uint8_t *p = gap_start();
+    const uint8_t *sp = (const uint8_t *)SP;
+
+    while(p < sp && *p == RAM_PAINT)
+        ++p;
+    return p - gap_start();
+}
+
+uint8_t ram_check(void)
+{
+    static uint8_t ok = 1;
+    const uint8_t *p = gap_start();
+
+    if(!ok)
+        return 0;
+    for(uint8_t i = 0; i < RAM_GUARD; ++i)
+        if(p[i] != RAM_PAINT)
+        {
+            ok = 0;
+            BBOX_FAULT(BBOX_FAULT_STACK, i);
+            break;
+        }
+    return ok;
+}
+#else
+// No AVR memory map on the host
+uint16_t ram_static(void)
+{
+    return 0;
+}
+
+uint16_t ram_free(void)
+{
+    return 0;
+}
+
+uint16_t ram_min_free(void)
+{
+    return 0;
+}
+
+uint8_t ram_check(void)
+{
+    return 1;
+}
+#endif /* HOST */
+
+void ram_command(int c)
+{
+    static uint8_t pending = 0;
+    char buf[REPORT_LINE+1];
+    uint8_t len;
+
+    if(c == 'm')
+        pending = 1;
+    if(!pending)
+        return;
+
+    len = serial_fmt_str(buf, 0, "ram: static ");
+    len = serial_fmt_u(buf, len, ram_static());
+    len = serial_fmt_str(buf, len, " free ");
+    len = serial_fmt_u(buf, len, ram_free());
+    len = serial_fmt_str(buf, len, " min ");
+    len = serial_fmt_u(buf, len, ram_min_free());
+    len = serial_fmt_str(buf, len, "\r\n");
+#ifdef TELEMETRY
+    // Ends a block the decoder drops as bad; the next frame is untouched
+    buf[len++] = TLM_DELIM;
+#endif
+    // Otherwise try again next pass
+    if(serial_write_room(buf, len, REPORT_ROOM))
+        pending = 0;
+}
+
+#endif /* RAMCHECK */
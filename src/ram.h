@@ -0,0 +1,79 @@
+/** @file
+ * @brief SRAM and stack usage.
+ *
+ * The ATmega328P has 2 KB of SRAM: the static data (.data and .bss) at
+ * the bottom, the stack growing down from the top and nothing between
+ * them to notice when they meet. At reset, before the C runtime sets up
+ * the stack, ram_paint() fills the whole gap with #RAM_PAINT. The stack
+ * overwrites the paint as it grows, so the bytes still painted at the
+ * bottom of the gap are the least free RAM there has ever been.
+ *
+ *  - ram_static(): bytes of static data
+ *  - ram_free(): bytes between the static data and the stack now
+ *  - ram_min_free(): the high-water mark, scanned from the paint
+ *  - ram_check(): looks only at the #RAM_GUARD bytes at the bottom of the
+ *    gap, cheap enough for every #TASK_HOUSEKEEPING pass, and records a
+ *    #BBOX_FAULT_STACK fault the first time one has been overwritten
+ *
+ * Serial command @c 'm', see ram_command(), sends
+ * "ram: static <bytes> free <bytes> min <bytes>".
+ *
+ * The static RAM of every module is reported at build time by the @c ram
+ * target in bin/Makefile, which fails the build when less than
+ * @c RAM_HEADROOM bytes would be left for the stack.
+ *
+ * Host builds have no AVR memory map; the counts read 0 there.
+ *
+ * @date    10/18/2026
+ */
+#ifndef RAM_H
+#define RAM_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+/** @name RAM Check Defines */
+//@{
+#define RAM_PAINT   0xC5    ///<Fill byte of the unused RAM
+#define RAM_GUARD   16      ///<Bytes at the bottom of the gap ram_check() watches
+//@}
+
+#ifdef RAMCHECK
+
+/**
+ * @return bytes of .data and .bss
+ */
+uint16_t ram_static(void);
+
+/**
+ * @return bytes between the end of the static data (and heap) and the
+ *         stack pointer
+ */
+uint16_t ram_free(void);
+
+/**
+ * @brief Scan the paint up from the end of the static data.
+ *
+ * Takes a few cycles per free byte; call from the main task only.
+ *
+ * @return the fewest free bytes there have been since reset
+ */
+uint16_t ram_min_free(void);
+
+/**
+ * @brief Check the #RAM_GUARD bytes at the bottom of the gap.
+ *
+ * @return 0 once the stack has reached them
+ */
+uint8_t ram_check(void);
+
+/**
+ * @brief Handle serial command @c c and send a pending report.
+ *
+ * Call once per main loop pass with the received byte, or -1.
+ */
+void ram_command(int c);
+
+#endif /* RAMCHECK */
+
+#endif /* RAM_H */
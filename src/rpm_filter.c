@@ -0,0 +1,104 @@
+/**
+ *  @file
+ *  @brief Incremental rpm filter pipeline.
+ *
+ *  @date    10/18/2026
+ */
+#include <string.h>
+#include "rpm_filter.h"
+
+#define SLOPE_MAX_STEP  2000    ///<Largest step used for the slope (rpm)
+
+#if RPM_MEDIAN_LEN
+/**
+ * @brief Median of the window, by insertion sort of a copy.
+ */
+static uint16_t median(const uint16_t *win)
+{
+    uint16_t v[RPM_MEDIAN_LEN];
+
+    for(uint8_t i = 0; i < RPM_MEDIAN_LEN; ++i)
+    {
+        uint16_t x = win[i];
+        uint8_t j = i;
+
+        for(; j > 0 && v[j-1] > x; --j)
+            v[j] = v[j-1];
+        v[j] = x;
+    }
+    return v[RPM_MEDIAN_LEN/2];
+}
+#endif
+
+void rpm_filter_update(Rpm_Filter *f, uint16_t raw, uint32_t us)
+{
+    uint16_t x = raw;
+
+#if RPM_MEDIAN_LEN
+    f->med_win[f->med_index] = raw;
+    if(++f->med_index == RPM_MEDIAN_LEN)
+        f->med_index = 0;
+    x = median(f->med_win);
+#endif
+    f->median = x;
+
+#if RPM_HIST_LEN
+    // Running sum: add the newest, drop the one it replaces
+    f->sum += x;
+    f->sum -= f->hist[f->index];
+    f->hist[f->index] = x;
+    if(++f->index == RPM_HIST_LEN)
+        f->index = 0;
+    f->ave = f->sum/RPM_HIST_LEN;
+#else
+    f->ave = x;
+#endif
+
+#if RPM_EMA_SHIFT
+    {
+        int32_t err = ((int32_t)x << RPM_EMA_FRAC) - (int32_t)f->ema_acc;
+
+        f->ema_acc += err >> RPM_EMA_SHIFT;
+        f->ema = f->ema_acc >> RPM_EMA_FRAC;
+    }
+#else
+    f->ema = x;
+#endif
+
+#if RPM_SLOPE
+    if(f->prev_us && us != f->prev_us)
+    {
+        int32_t step = (int32_t)x - f->prev;
+        uint32_t dt = us - f->prev_us;
+        int32_t d;
+
+        // Clamped so step*1e6 fits in 32 bits
+        if(step > SLOPE_MAX_STEP)
+            step = SLOPE_MAX_STEP;
+        else if(step < -SLOPE_MAX_STEP)
+            step = -SLOPE_MAX_STEP;
+        if(dt > INT32_MAX)
+            dt = INT32_MAX;
+        d = step*1000000L/(int32_t)dt;
+        if(d > INT16_MAX)
+            d = INT16_MAX;
+        else if(d < -INT16_MAX)
+            d = -INT16_MAX;
+#if RPM_EMA_SHIFT
+        f->slope_acc += ((d << RPM_EMA_FRAC) - f->slope_acc) >> RPM_EMA_SHIFT;
+        f->slope = f->slope_acc >> RPM_EMA_FRAC;
+#else
+        f->slope = d;
+#endif
+    }
+    f->prev = x;
+    f->prev_us = us;
+#else
+    f->slope = 0;
+#endif
+}
+
+void rpm_filter_reset(Rpm_Filter *f)
+{
+    memset(f, 0, sizeof(*f));
+}
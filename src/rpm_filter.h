@@ -0,0 +1,77 @@
+/** @file
+ * @brief Incremental rpm filter pipeline.
+ *
+ * Each raw sample is run through the pipeline once, when it arrives:
+ *  -# median of the last #RPM_MEDIAN_LEN samples, to reject single spikes
+ *  -# moving average over #RPM_HIST_LEN medians, kept as a running sum
+ *  -# exponential moving average with weight 1/2^#RPM_EMA_SHIFT
+ *  -# slope in rpm/s from consecutive medians and their timestamps,
+ *     smoothed with the same EMA weight
+ *
+ * Every stage is O(1) (the median sorts at most five values). Setting a
+ * length or shift to 0, or #RPM_SLOPE to 0, removes that stage at compile
+ * time; its output then follows the stage before it.
+ *
+ * @date    10/18/2026
+ */
+#ifndef RPM_FILTER_H
+#define RPM_FILTER_H 1
+
+#include <stdint.h>
+#include "defines.h"
+
+#if RPM_MEDIAN_LEN != 0 && RPM_MEDIAN_LEN != 3 && RPM_MEDIAN_LEN != 5
+#error "RPM_MEDIAN_LEN must be 0, 3 or 5"
+#endif
+
+#define RPM_EMA_FRAC    4   ///<Fraction bits kept by the EMA accumulators
+
+/// Filter state and outputs.
+typedef struct
+{
+    uint16_t median;    ///< Spike-rejected rpm
+    uint16_t ave;       ///< Moving average rpm
+    uint16_t ema;       ///< Exponential moving average rpm
+    int16_t  slope;     ///< Rate of change (rpm/s)
+#if RPM_MEDIAN_LEN
+    uint16_t med_win[RPM_MEDIAN_LEN];   ///< Last raw samples
+    uint8_t  med_index;
+#endif
+#if RPM_HIST_LEN
+    uint16_t hist[RPM_HIST_LEN];        ///< Last medians
+    uint8_t  index;
+    uint32_t sum;                       ///< Sum of @c hist
+#endif
+#if RPM_EMA_SHIFT
+    uint32_t ema_acc;   ///< EMA, #RPM_EMA_FRAC fraction bits
+#endif
+#if RPM_SLOPE
+    int32_t  slope_acc; ///< Slope EMA, #RPM_EMA_FRAC fraction bits
+    uint16_t prev;      ///< Previous median
+    uint32_t prev_us;   ///< Time of the previous sample, 0 before the first
+#endif
+} Rpm_Filter;
+
+/**
+ * @brief Run one sample through the pipeline.
+ *
+ * Called from the ISR that produced the sample.
+ *
+ * @param   f       filter to update
+ * @param   raw     new rpm sample
+ * @param   us      time of the sample, see micros()
+ */
+void rpm_filter_update(Rpm_Filter *f, uint16_t raw, uint32_t us);
+
+/**
+ * @brief Clear every stage, as if only 0 rpm had ever been seen.
+ *
+ * For a stall: the median would drop a single 0 sample as a spike and the
+ * average would barely move, and with no more edges they would keep the
+ * last running rpm.
+ *
+ * @param   f       filter to clear
+ */
+void rpm_filter_reset(Rpm_Filter *f);
+
+#endif /* RPM_FILTER_H */
@@ -0,0 +1,101 @@
+/**
+ *  @file
+ *  @brief Cooperative run-to-completion task scheduler.
+ *
+ *  @date    10/18/2026
+ */
+#include <string.h>
+#include "SAE_AutoShifter.h"
+#include "sched.h"
+#include "bbox.h"
+
+Task sched_tasks[TASKS];
+volatile uint8_t sched_ready;
+
+/**
+ * @brief Timer callback: periodic release of task @c arg.
+ */
+static void release(void *arg)
+{
+    Task *t = arg;
+
+    // As of its expiry, however late the wheel runs
+    sched_release(t - sched_tasks, timer_now());
+}
+
+void sched_init(void)
+{
+    memset(sched_tasks, 0, sizeof(sched_tasks));
+    sched_ready = 0;
+    // Timers, ADC and USART keep running while the CPU waits
+    set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+void sched_add(uint8_t id, void (*fn)(void), uint16_t period,
+               uint16_t deadline)
+{
+    Task *t = &sched_tasks[id];
+
+    t->fn = fn;
+    t->deadline = deadline;
+    t->missed = 0;
+    sched_period(id, period);
+}
+
+void sched_period(uint8_t id, uint16_t period)
+{
+    Task *t = &sched_tasks[id];
+
+    t->period = period;
+    if(period)
+        timer_start(&t->timer, period, period, release, t);
+    else
+        timer_stop(&t->timer);
+}
+
+void sched_run(void)
+{
+    uint8_t sreg = SREG;
+    uint8_t ready;
+    uint8_t ran = 0;
+
+    cli();
+    ready = sched_ready;
+    sched_ready = 0;
+    SREG = sreg;
+
+    for(uint8_t i = 0; i < TASKS; ++i)
+    {
+        Task *t = &sched_tasks[i];
+        uint16_t late;
+
+        if(!t->fn || !(ready & _BV(i)))
+            continue;
+
+        t->fn();
+        ran = 1;
+        // A soft deadline: logged, but not a fault that freezes the box
+        late = (uint16_t)millis() - t->release;
+        if(late > t->deadline)
+        {
+            ++t->missed;
+            BBOX_LOG(BBOX_LATE, (uint16_t)i << 8 |
+                                (late > 0xFF ? 0xFF : late));
+        }
+    }
+    if(ran)
+        return;
+
+    // Nothing to do: sleep, unless an ISR posted work since the check.
+    // The instruction after sei() runs before any interrupt, so a post
+    // cannot slip in between the test and the sleep.
+    cli();
+    if(!sched_ready)
+    {
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    SREG = sreg;
+}
@@ -0,0 +1,108 @@
+/** @file
+ * @brief Cooperative run-to-completion task scheduler.
+ *
+ * The main task is a fixed set of #Task_Id tasks, each a function that runs
+ * to completion. A task is released either periodically, every @c period
+ * ms from its first release by a timer on the wheel in timer.h, or by
+ * sched_post() when there is work for it, or both. sched_run()
+ * runs every released task once, in #Task_Id order, which is also their
+ * priority; #TASK_TIMER, which runs the wheel, comes first. When nothing
+ * is released the CPU sleeps in #SLEEP_MODE_IDLE until the next interrupt.
+ *
+ * A task that finishes more than @c deadline ms after its release counts a
+ * miss and logs #BBOX_LATE to the black box. A posted release counts from
+ * the sched_post() and a periodic one from the time its timer expired; a
+ * task released again before it ran keeps the first time. A periodic task
+ * that falls a whole period behind skips the releases it missed rather
+ * than running back to back.
+ *
+ * @date    10/18/2026
+ */
+#ifndef SCHED_H
+#define SCHED_H 1
+
+#include <stdint.h>
+#include "hal.h"
+#include "timer.h"
+#include "SAE_AutoShifter.h"
+
+/// Tasks of the main task, highest priority first.
+typedef enum
+{
+    TASK_TIMER,         ///< Software timers, posted every tick
+    TASK_PADDLE,        ///< Paddle events, posted by the debounce
+    TASK_SHIFT,         ///< Automatic shift decisions, posted per rpm sample
+    TASK_OUTPUT,        ///< Telemetry frames or the text printout
+    TASK_HOUSEKEEPING,  ///< Heartbeat and serial commands
+    TASKS
+} Task_Id;
+
+/// One task.
+typedef struct
+{
+    void     (*fn)(void);   ///< Body, runs to completion
+    uint16_t period;        ///< Release period (ms), 0 if only posted
+    uint16_t deadline;      ///< Finish within this of the release (ms)
+    uint16_t release;       ///< Pending release (ms)
+    uint16_t missed;        ///< Deadlines missed
+    Timer    timer;         ///< Periodic release
+} Task;
+
+extern Task sched_tasks[TASKS];         ///<The task table
+extern volatile uint8_t sched_ready;    ///<Posted tasks, one bit per #Task_Id
+
+/**
+ * @brief Clear the task table and select #SLEEP_MODE_IDLE. Call after
+ * timer_init().
+ */
+void sched_init(void);
+
+/**
+ * @brief Add task @c id. The first periodic release is one period away.
+ *
+ * @param   id          task to set up
+ * @param   fn          body
+ * @param   period      release period (ms), 0 for posted only
+ * @param   deadline    allowed time from release to finish (ms)
+ */
+void sched_add(uint8_t id, void (*fn)(void), uint16_t period,
+               uint16_t deadline);
+
+/**
+ * @brief Change the release period of task @c id. The next periodic
+ * release is one new period away; 0 leaves it posted only.
+ */
+void sched_period(uint8_t id, uint16_t period);
+
+/**
+ * @brief Release task @c id at the next sched_run(), as of @c ms.
+ *
+ * A task already released keeps its earlier release time.
+ */
+static inline void sched_release(uint8_t id, uint16_t ms)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    if(!(sched_ready & _BV(id)))
+        sched_tasks[id].release = ms;
+    sched_ready |= _BV(id);
+    SREG = sreg;
+}
+
+/**
+ * @brief Release task @c id at the next sched_run(), as of now.
+ *
+ * From ISRs and from the main task, timer callbacks included.
+ */
+static inline void sched_post(uint8_t id)
+{
+    sched_release(id, millis());
+}
+
+/**
+ * @brief Run every released task once, or sleep if there are none.
+ */
+void sched_run(void);
+
+#endif /* SCHED_H */
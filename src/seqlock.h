@@ -0,0 +1,81 @@
+/** @file
+ * @brief Sequence lock for state the ISRs publish to the main task.
+ *
+ * The writer bumps the sequence number before and after it updates the
+ * state, so the number is odd while an update is under way. A reader
+ * notes the number, copies the state and checks the number again; if it
+ * changed, an ISR wrote in between and the copy is taken again. Neither
+ * side disables interrupts, so the copy can be as large as it needs to be
+ * without holding off the ISRs, and a 16 or 32 bit value is never seen
+ * half written.
+ *
+ * Readers run in main context. Writers run in ISRs, or in main context
+ * with interrupts disabled, so two writers never interleave. On the AVR an
+ * ISR runs to completion before the main task resumes, so a reader retries
+ * at most once per interrupt that hits its copy.
+ *
+ * @code
+ * uint8_t seq;
+ * do
+ * {
+ *     seq = seqlock_read_begin(&lock);
+ *     copy = shared;
+ * }while(seqlock_read_retry(&lock, seq));
+ * @endcode
+ *
+ * @date    10/18/2026
+ */
+#ifndef SEQLOCK_H
+#define SEQLOCK_H 1
+
+#include <stdint.h>
+#include "hal.h"
+
+/// A sequence lock.
+typedef struct
+{
+    volatile uint8_t seq;   ///< Odd while a write is under way
+} Seqlock;
+
+/**
+ * @brief Start an update of the state @c l guards.
+ */
+static inline void seqlock_write_begin(Seqlock *l)
+{
+    l->seq = l->seq + 1;
+    HAL_BARRIER();
+}
+
+/**
+ * @brief Publish the update.
+ */
+static inline void seqlock_write_end(Seqlock *l)
+{
+    HAL_BARRIER();
+    l->seq = l->seq + 1;
+}
+
+/**
+ * @return the sequence number to pass to seqlock_read_retry()
+ */
+static inline uint8_t seqlock_read_begin(const Seqlock *l)
+{
+    uint8_t seq;
+
+    while((seq = l->seq) & 1)
+        ;
+    HAL_BARRIER();
+    return seq;
+}
+
+/**
+ * @return 1 if the state changed since seqlock_read_begin() returned @c seq
+ *         and the copy must be taken again
+ */
+static inline uint8_t seqlock_read_retry(const Seqlock *l, uint8_t seq)
+{
+    HAL_BARRIER();
+    return l->seq != seq;
+}
+
+#endif /* SEQLOCK_H */
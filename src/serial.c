@@ -5,47 +5,209 @@
 */
 
 #include "serial.h"
-#include "avr/io.h"
+#include "sched.h"
+#include "prof.h"
 #include <stdio.h>
 
+#define TX_MASK (SERIAL_TX_BUF_LEN - 1)
+#define RX_MASK (SERIAL_RX_BUF_LEN - 1)
+
+/* Single producer (main context), single consumer (UDRE interrupt).
+   Only the producer moves tx_head and only the consumer moves tx_tail,
+   so neither side needs to disable interrupts. */
+static uint8_t tx_buf[SERIAL_TX_BUF_LEN];
+static volatile uint8_t tx_head;
+static volatile uint8_t tx_tail;
+
+/* The other way round: the RX interrupt moves rx_head, main context
+   moves rx_tail. */
+static uint8_t rx_buf[SERIAL_RX_BUF_LEN];
+static volatile uint8_t rx_head;
+static volatile uint8_t rx_tail;
+
+volatile uint16_t serial_tx_dropped;
+volatile uint16_t serial_rx_dropped;
+
+#ifndef HOST
 static int USART_Transmit(char data , FILE* stream);
 static int USART_Receive(FILE* stream );
 
 static FILE stdiostream = FDEV_SETUP_STREAM(USART_Transmit,USART_Receive,_FDEV_SETUP_RW);
+#endif /* HOST */
 
 static void USART_Init( unsigned int ubrr){
+	/* Select double speed if asked for */
+	if (ubrr & USART_2X)
+		UCSR0A = (1<<U2X0);
+	else
+		UCSR0A = 0;
+	ubrr &= ~USART_2X;
 	/* Set baud rate */
 	UBRR0H = (unsigned char)(ubrr>>8);
 	UBRR0L = (unsigned char)ubrr;
-	/* Enable receiver and transmitter */
-	UCSR0B = (1<<RXEN0)|(1<<TXEN0);
+	/* Enable receiver, its interrupt and transmitter */
+	UCSR0B = (1<<RXEN0)|(1<<RXCIE0)|(1<<TXEN0);
 	/* Set frame format: 8data, 1stop bit */
 	UCSR0C = (0<<USBS0)|(0<<UCSZ02)|(1<<UCSZ01)|(1<<UCSZ00);
 } // USART_Init
 
+uint8_t serial_tx_free(void)
+{
+	return (uint8_t)(TX_MASK - ((tx_head - tx_tail) & TX_MASK));
+}
+
+int serial_putc(uint8_t c)
+{
+	uint8_t next = (tx_head + 1) & TX_MASK;
+
+	if (next == tx_tail) {
+		++serial_tx_dropped;
+		return -1;
+	}
+	tx_buf[tx_head] = c;
+	HAL_BARRIER();
+	tx_head = next;
+	/* Kick the transmitter; the ISR turns this off when it runs dry */
+	UCSR0B |= (1<<UDRIE0);
+	return 0;
+}
+
+uint8_t serial_write(const void *data, uint8_t len)
+{
+	const uint8_t *p = data;
+	uint8_t head = tx_head;
+
+	if (len > serial_tx_free()) {
+		serial_tx_dropped += len;
+		return 0;
+	}
+	while (len--) {
+		tx_buf[head] = *p++;
+		head = (head + 1) & TX_MASK;
+	}
+	/* Publish the whole write at once */
+	HAL_BARRIER();
+	tx_head = head;
+	UCSR0B |= (1<<UDRIE0);
+	return (uint8_t)(p - (const uint8_t *)data);
+}
+
+uint8_t serial_fmt_str(char *buf, uint8_t len, const char *s)
+{
+	while (*s)
+		buf[len++] = *s++;
+	return len;
+}
+
+uint8_t serial_fmt_u(char *buf, uint8_t len, uint16_t v)
+{
+	char digit[5];
+	uint8_t n = 0;
+
+	/* Least significant first, then reversed into place */
+	do {
+		digit[n++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+	while (n)
+		buf[len++] = digit[--n];
+	return len;
+}
+
+uint8_t serial_fmt_ul(char *buf, uint8_t len, uint32_t v)
+{
+	/* The 16 bit divisions are much cheaper on the part */
+	if (v <= UINT16_MAX)
+		return serial_fmt_u(buf, len, v);
+	len = serial_fmt_ul(buf, len, v / 10000);
+	v %= 10000;
+	/* Leading zeros of the low four digits */
+	for (uint16_t p = 1000; p > 1 && v < p; p /= 10)
+		buf[len++] = '0';
+	return serial_fmt_u(buf, len, v);
+}
+
+int serial_getc(void)
+{
+	uint8_t tail = rx_tail;
+	uint8_t c;
+
+	if (tail == rx_head)
+		return -1;
+	c = rx_buf[tail];
+	HAL_BARRIER();
+	rx_tail = (tail + 1) & RX_MASK;
+	return c;
+}
+
+uint8_t serial_write_room(const void *data, uint8_t len, uint8_t room)
+{
+	if (len + room > serial_tx_free())
+		return 0;
+	return serial_write(data, len);
+}
+
+ISR(USART_UDRE_vect)
+{
+	PROF_ISR_BEGIN(PROF_USART_UDRE);
+	uint8_t tail = tx_tail;
+
+	if (tail == tx_head) {
+		/* Nothing left to send */
+		UCSR0B &= ~(1<<UDRIE0);
+	} else {
+		UDR0 = tx_buf[tail];
+		tx_tail = (tail + 1) & TX_MASK;
+	}
+	PROF_ISR_END(PROF_USART_UDRE);
+}
+
+ISR(USART_RX_vect)
+{
+	PROF_ISR_BEGIN(PROF_USART_RX);
+	uint8_t head = rx_head;
+	uint8_t next = (head + 1) & RX_MASK;
+	uint8_t c = UDR0;
+
+#ifdef HOST
+	/* The part clears RXC0 when UDR0 is read */
+	UCSR0A &= ~(1<<RXC0);
+#endif
+	if (next == rx_tail) {
+		++serial_rx_dropped;
+	} else {
+		rx_buf[head] = c;
+		rx_head = next;
+		/* The command line reads it, see cmd.h */
+		sched_post(TASK_HOUSEKEEPING);
+	}
+	PROF_ISR_END(PROF_USART_RX);
+}
+
+#ifndef HOST
 static int USART_Transmit(char data , FILE* stream)
 {
-	/* Wait for empty transmit buffer */
-	while ( !( UCSR0A & (1<<UDRE0)) )
-	;
-	/* Put data into buffer, sends the data */
-	UDR0 = data;
+	/* Queue the data; on overflow it is dropped rather than waited on */
+	serial_putc(data);
 	return 0;
 }
 
 static int USART_Receive( FILE* stream )
 {
-	/* Wait for data to be received */
-	while ( !(UCSR0A & (1<<RXC0)) )
+	int c;
+
+	/* Wait for the RX interrupt to deliver a byte */
+	while ( (c = serial_getc()) < 0 )
 	;
-	/* Get and return received data from buffer */
-	return UDR0;
+	return c;
 }
+#endif /* HOST */
 
 void init_usart(unsigned int baudrate) {
 	USART_Init(baudrate);
+#ifndef HOST
+	/* The host build keeps the process' own stdio */
 	stdout = &stdiostream;
 	stdin = &stdiostream;
+#endif
 }
-
-
@@ -1,30 +1,101 @@
-/* 
+/*
  * serial.h
  * Simple serial I/O for AVR - uses USART 0
- * void init_usart(usigned int baudrate) : Initializes stdio to USART0, 
- * so that standard I/O routines can be used, such as getchar(), putchar(), etc. 
+ * void init_usart(usigned int baudrate) : Initializes stdio to USART0,
+ * so that standard I/O routines can be used, such as getchar(), putchar(), etc.
+ *
+ * Transmission is interrupt driven. Characters are queued in a ring buffer
+ * of SERIAL_TX_BUF_LEN bytes and sent from the UDRE interrupt, so writers
+ * never wait on the line. When the buffer is full the data is dropped and
+ * counted in serial_tx_dropped.
+ *
+ * Reception is interrupt driven too. The RX interrupt moves each byte into
+ * a ring buffer of SERIAL_RX_BUF_LEN bytes and posts TASK_HOUSEKEEPING,
+ * which reads them with serial_getc() without waiting. Bytes that arrive
+ * to a full buffer are dropped and counted in serial_rx_dropped.
  */
 
 #ifndef SERIAL_H
 #define SERIAL_H
 
+#include <stdint.h>
+#include "hal.h"
+
 // Constant Definitions
 // --------------------
 #define LF '\n'           /* line feed */
 #define CR '\r'           /* carriage return */
 
+// Size of the transmit ring buffer. Must be a power of 2, at most 256.
+#ifndef SERIAL_TX_BUF_LEN
+#define SERIAL_TX_BUF_LEN 64
+#endif
+
+#if (SERIAL_TX_BUF_LEN & (SERIAL_TX_BUF_LEN - 1)) || SERIAL_TX_BUF_LEN > 256
+#error "SERIAL_TX_BUF_LEN must be a power of 2 no larger than 256"
+#endif
+
+// Size of the receive ring buffer. Must be a power of 2, at most 256.
+#ifndef SERIAL_RX_BUF_LEN
+#define SERIAL_RX_BUF_LEN 32
+#endif
+
+#if (SERIAL_RX_BUF_LEN & (SERIAL_RX_BUF_LEN - 1)) || SERIAL_RX_BUF_LEN > 256
+#error "SERIAL_RX_BUF_LEN must be a power of 2 no larger than 256"
+#endif
+
+// Flag or'ed into a baud value to select double speed (U2X0) operation
+#define USART_2X 0x8000
+
 // Note: F_CPU is defined on the command line for the compiler
 #define UBRR_V(Baud)	((F_CPU/16/Baud) - 1)
+#define UBRR_V2X(Baud)	(((F_CPU/8/Baud) - 1) | USART_2X)
 
 // values for baud registers, based on clock frequency.
-#define Baud115200 (UBRR_V(115200))
+#define Baud1000000 (UBRR_V2X(1000000))
+#define Baud500000 (UBRR_V2X(500000))
+#define Baud250000 (UBRR_V2X(250000))
+#define Baud115200 (UBRR_V2X(115200))
 #define Baud57600  (UBRR_V(57600))
 #define Baud38400  (UBRR_V(38400))
 #define Baud19200  (UBRR_V(19200))
 #define Baud9600   (UBRR_V(9600))
 
+extern volatile uint16_t serial_tx_dropped; /* bytes lost to a full buffer */
+extern volatile uint16_t serial_rx_dropped; /* bytes lost to a full buffer */
+
 // Function Prototypes
 // -------------------
 void init_usart(unsigned int baudrate);
 
+/* Queue one byte. Returns 0, or -1 if the buffer was full and c dropped */
+int serial_putc(uint8_t c);
+
+/* Queue len bytes, all or nothing. Returns len, or 0 if they did not fit */
+uint8_t serial_write(const void *data, uint8_t len);
+
+/* Queue len bytes only if room more bytes stay free after them, for
+   output that must not crowd out other traffic. Returns len, or 0 if they
+   were not queued; nothing is counted as dropped */
+uint8_t serial_write_room(const void *data, uint8_t len, uint8_t room);
+
+/* Number of bytes that can be queued without dropping */
+uint8_t serial_tx_free(void);
+
+/* Next received byte, or -1 if there is none. Never waits */
+int serial_getc(void);
+
+/* Text for reply and report lines without stdio, which would link
+   vfprintf into TELEMETRY builds. Each appends to buf at len and returns
+   the new length; the caller leaves room for the result */
+uint8_t serial_fmt_str(char *buf, uint8_t len, const char *s);
+uint8_t serial_fmt_u(char *buf, uint8_t len, uint16_t v);
+uint8_t serial_fmt_ul(char *buf, uint8_t len, uint32_t v);
+
+/* Transmit buffer empty: moves the next queued byte into UDR0 */
+ISR(USART_UDRE_vect);
+
+/* Byte received: moves it from UDR0 into the receive buffer */
+ISR(USART_RX_vect);
+
 #endif /* SERIAL_H */
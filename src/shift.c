@@ -0,0 +1,229 @@
+/**
+ *  @file
+ *  @brief Non-blocking shift sequencer.
+ *
+ *  @date    10/18/2026
+ */
+#include "SAE_AutoShifter.h"
+#include "shift.h"
+#include "calib.h"
+#include "bbox.h"
+#include "timer.h"
+#include "adapt.h"
+
+#define QUEUE_MASK  (SHIFT_QUEUE_LEN-1)
+
+#if SHIFT_QUEUE_LEN & QUEUE_MASK || SHIFT_QUEUE_LEN > 128
+#error "SHIFT_QUEUE_LEN must be a power of 2, at most 128"
+#endif
+
+/// A queued shift.
+typedef struct
+{
+    uint8_t  direction; ///< #SOLEN_UP or #SOLEN_DN
+    uint16_t stamp;     ///< When it was asked for (ms)
+} Shift_Request;
+
+// Requests: queued by shift_request(), started by shift_phase(). The
+// indices run free and are masked on use, so every slot can be filled.
+static Shift_Request    queue[SHIFT_QUEUE_LEN];
+static uint8_t  q_head;
+static uint8_t  q_tail;
+
+static Shift_State state;
+static uint8_t  direction;      ///<Direction of the running shift
+static uint16_t stamp;          ///<Request time of the running shift
+static uint8_t  ign_ms;         ///<Ignition cut of the running shift
+static uint8_t  solen_ms;       ///<Solenoid hold of the running shift
+static uint16_t rpm_before;     ///<Rpm when its ignition was cut
+static uint32_t restored_us;    ///<When its ignition came back
+static uint16_t latency;        ///<Request to solenoid, last shift (ms)
+static Timer    phase;          ///<Ends the current phase
+static const Gear *target;      ///<Gear after all requests (main only)
+static uint8_t  refused;        ///<Direction of the last refused request
+
+static void shift_phase(void *arg);
+
+void shift_init(void)
+{
+    q_head = q_tail = 0;
+    state = SHIFT_IDLE;
+    timer_stop(&phase);
+    target = gear_;
+    refused = 0;
+}
+
+uint8_t shift_request(uint8_t direction, uint16_t stamp)
+{
+    const Gear *g = direction == SOLEN_UP ? target->next : target->prev;
+
+    if(g == 0 || (uint8_t)(q_head - q_tail) == SHIFT_QUEUE_LEN)
+    {
+        // Once per run of refusals, they repeat every pass
+        if(refused != direction)
+            BBOX_LOG(BBOX_REQUEST, (uint16_t)direction << 8);
+        refused = direction;
+        return 0;
+    }
+    refused = 0;
+
+    queue[q_head & QUEUE_MASK].direction = direction;
+    queue[q_head & QUEUE_MASK].stamp = stamp;
+    ++q_head;
+    target = g;
+    BBOX_LOG(BBOX_REQUEST, (uint16_t)direction << 8 | 1);
+    // Idle: start it on the next tick, as a settled sequencer would
+    if(!timer_active(&phase))
+        timer_start(&phase, 1, 0, shift_phase, 0);
+    return 1;
+}
+
+const Gear *shift_target(void)
+{
+    return target;
+}
+
+Shift_State shift_state(void)
+{
+    return state;
+}
+
+uint16_t shift_lead_rpm(uint8_t gear, int16_t slope, uint16_t age_ms)
+{
+    uint32_t ms = adapt_ign_ms(SOLEN_UP, gear) +
+                  adapt_solen_ms(SOLEN_UP, gear) + calib.engage_ms;
+    uint32_t lead;
+
+    if(slope <= 0)
+        return 0;
+    // In 1/100 ms; a sample this old says little about the rpm now
+    ms = ms*calib.lead_pct[gear-1] +
+         100UL*(age_ms < SHIFT_LEAD_AGE_MAX ? age_ms : SHIFT_LEAD_AGE_MAX);
+    // 32767 rpm/s * (765 * 200 + 100000) / 100 ms < 2^32
+    lead = (uint32_t)slope*(ms/100)/1000;
+    return lead > calib.lead_max ? calib.lead_max : lead;
+}
+
+uint16_t shift_latency(void)
+{
+    return latency;
+}
+
+uint8_t shift_busy(void)
+{
+    return state != SHIFT_IDLE || q_head != q_tail;
+}
+
+/**
+ * @brief Commit the gear change once the ignition is back.
+ */
+static void commit(void)
+{
+    if(direction == SOLEN_UP)
+        gear_ = gear_->next;
+    else
+        gear_ = gear_->prev;
+}
+
+#ifdef ADAPT
+/**
+ * @brief Take back the gear change of a shift that missed.
+ *
+ * The box is still in the old gear. The queued requests were made against
+ * the new one, so they are dropped; the shift logic asks again.
+ */
+static void uncommit(void)
+{
+    if(direction == SOLEN_UP)
+        gear_ = gear_->prev;
+    else
+        gear_ = gear_->next;
+    q_tail = q_head;
+    target = gear_;
+}
+
+/**
+ * @brief Judge the shift just settled, see adapt_result().
+ *
+ * Only a pulse period timed wholly in the new gear tells whether it
+ * engaged. A #TACH_COUNT sample spans #TACH_SAMPLE_MS, mostly before the
+ * shift, so those shifts are never judged.
+ */
+static uint8_t judge(void)
+{
+    uint8_t from = direction == SOLEN_UP ? gear_num() - 1 : gear_num() + 1;
+    uint16_t after = 0;
+#if TACH_MODE == TACH_PERIOD
+    Sensor_Snapshot snap;
+
+    sensor_snapshot(&snap);
+    if(snap.rpms && snap.us - restored_us < 0x80000000UL &&
+       snap.us - restored_us >= tach.k/snap.rpms)
+        after = snap.rpms;
+#endif
+    return adapt_result(direction, from, rpm_before, after);
+}
+#endif /* ADAPT */
+
+/**
+ * @brief Enter phase @c next for @c ms.
+ */
+static void enter(Shift_State next, uint8_t ms)
+{
+    state = next;
+    timer_start(&phase, ms, 0, shift_phase, 0);
+}
+
+static void shift_phase(void *arg)
+{
+    Shift_State prev = state;
+
+    (void)arg;
+
+    switch(state)
+    {
+        case SHIFT_SETTLE:
+            state = SHIFT_IDLE;
+#ifdef ADAPT
+            if(judge() == ADAPT_MISSED)
+                uncommit();
+#endif
+            // Start a queued shift right away
+            // fall through
+        case SHIFT_IDLE:
+            if(q_head == q_tail)
+                break;
+            direction = queue[q_tail & QUEUE_MASK].direction;
+            stamp = queue[q_tail & QUEUE_MASK].stamp;
+            ++q_tail;
+            ign_ms = adapt_ign_ms(direction, gear_num());
+            solen_ms = adapt_solen_ms(direction, gear_num());
+            rpm_before = median_rpms();
+            ECU_PORT |= _BV(IGNITION_INT);
+            enter(SHIFT_IGN_CUT, ign_ms);
+            break;
+        case SHIFT_IGN_CUT:
+            SOLEN_OP_PORT |= _BV(direction);
+            latency = timer_now() - stamp;
+            enter(SHIFT_SOLEN_ON, solen_ms);
+            break;
+        case SHIFT_SOLEN_ON:
+            SOLEN_OP_PORT &= ~_BV(direction);
+            enter(SHIFT_SOLEN_OFF, ign_ms);
+            break;
+        case SHIFT_SOLEN_OFF:
+            ECU_PORT &= ~_BV(IGNITION_INT);
+            restored_us = micros();
+            commit();
+            enter(SHIFT_IGN_RESTORE, 1);
+            break;
+        case SHIFT_IGN_RESTORE:
+            enter(SHIFT_SETTLE, calib.settle_ms);
+            break;
+        default:
+            state = SHIFT_IDLE;
+            break;
+    }
+    if(state != prev)
+        BBOX_LOG(BBOX_PHASE, (uint16_t)gear_num() << 8 | state);
+}
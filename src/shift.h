@@ -0,0 +1,110 @@
+/** @file
+ * @brief Non-blocking shift sequencer.
+ *
+ * A shift is a fixed sequence of output changes:
+ *  -# #SHIFT_IGN_CUT      ignition cut, for the cut time
+ *  -# #SHIFT_SOLEN_ON     solenoid energized, for the hold time
+ *  -# #SHIFT_SOLEN_OFF    solenoid released, ignition still cut, for the
+ *                         cut time
+ *  -# #SHIFT_IGN_RESTORE  ignition restored and the new gear committed
+ *  -# #SHIFT_SETTLE       hold off for @c calib.settle_ms before the next
+ *
+ * The cut and hold times are @c calib.ign_ms and @c calib.solen_ms, see
+ * calib.h, or with #ADAPT those learned for the gear and direction, see
+ * adapt.h. There the rpm at the end of #SHIFT_SETTLE tells whether the
+ * shift went through; if it missed, the gear committed is taken back and
+ * the queued requests are dropped.
+ *
+ * The main task only queues requests with shift_request(). Each phase
+ * ends on a one-shot timer, see timer.h, which starts the next, so the
+ * main task keeps running while a shift is in progress. Up to
+ * #SHIFT_QUEUE_LEN requests may be waiting besides the one running, which
+ * allows back-to-back paddle shifts.
+ *
+ * @date    10/18/2026
+ */
+#ifndef SHIFT_H
+#define SHIFT_H 1
+
+#include <stdint.h>
+
+#define SHIFT_QUEUE_LEN     2   ///<Shift requests that can wait (power of 2)
+
+/// Phase of the shift in progress.
+typedef enum
+{
+    SHIFT_IDLE,         ///< No shift in progress
+    SHIFT_IGN_CUT,      ///< Ignition cut, solenoid not yet energized
+    SHIFT_SOLEN_ON,     ///< Solenoid energized
+    SHIFT_SOLEN_OFF,    ///< Solenoid released, ignition still cut
+    SHIFT_IGN_RESTORE,  ///< Ignition restored, gear committed
+    SHIFT_SETTLE        ///< Waiting before the next shift may start
+} Shift_State;
+
+struct Gear;
+
+/**
+ * @brief Reset the sequencer. Call once #gear_ is set.
+ */
+void shift_init(void);
+
+/**
+ * @brief Queue a shift in @c direction.
+ *
+ * The request is checked against the gear the box will be in once every
+ * queued shift has completed, see shift_target().
+ *
+ * @param   direction   #SOLEN_UP or #SOLEN_DN
+ * @param   stamp       time the shift was asked for (low bits of #sys_ms),
+ *                      e.g. the paddle event time; see shift_latency()
+ * @return  1 if queued, 0 if there is no gear that way or the queue is full
+ */
+uint8_t shift_request(uint8_t direction, uint16_t stamp);
+
+/**
+ * @brief Rpm the engine gains before an upshift asked for now is through.
+ *
+ * An upshift takes its cut and hold times plus @c calib.engage_ms from
+ * the request to the next gear engaging, during which the engine keeps
+ * accelerating. Comparing the rpm plus this lead against the shift
+ * map starts the shift early enough to complete at the mapped rpm instead
+ * of overshooting it. The lead is the rise at @c slope over @c age_ms, the
+ * age of the rpm sample, plus @c calib.lead_pct[gear-1] percent of the
+ * actuation time. How much of that time the engine keeps pulling depends
+ * on how quickly the ignition cut takes effect, hence the per gear
+ * calibration. The lead is never more than @c calib.lead_max, so a noisy
+ * slope cannot shift far below the map.
+ *
+ * @param   gear    gear shifting up, 1 to #MAX_GEARS
+ * @param   slope   rpm/s, see rpm_filter.h
+ * @param   age_ms  time since the rpm was sampled
+ * @return  rpm to add before comparing against the map, 0 when not rising
+ */
+uint16_t shift_lead_rpm(uint8_t gear, int16_t slope, uint16_t age_ms);
+
+/**
+ * @brief The gear the box is heading for.
+ *
+ * This is #gear_ with all queued and running shifts applied. Shift
+ * decisions should be made against it so a shift still in progress is not
+ * requested twice. Main context only.
+ */
+const struct Gear *shift_target(void);
+
+/**
+ * @return the current phase of the sequencer
+ */
+Shift_State shift_state(void);
+
+/**
+ * @return ms from the request stamp of the last shift to its solenoid
+ *         being energized
+ */
+uint16_t shift_latency(void);
+
+/**
+ * @return 1 while a shift is running or waiting
+ */
+uint8_t shift_busy(void);
+
+#endif /* SHIFT_H */
@@ -0,0 +1,43 @@
+/**
+ *  @file
+ *  @brief Gear by throttle shift map.
+ *
+ *  @date    10/18/2026
+ */
+#include "defines.h"
+#include "shiftmap.h"
+#include "calib.h"
+
+/**
+ * @brief Interpolate the row of @c gear in the upshift or downshift map at
+ * throttle @c tps.
+ */
+static uint16_t lookup(uint8_t up, uint8_t gear, uint8_t tps)
+{
+    const uint8_t *x = calib.tps;
+    uint8_t i = 0;
+    uint16_t y0, y1;
+
+    if(tps <= x[0])
+        return calib_cell(&calib, up, gear, 0);
+
+    // Find the segment [x[i], x[i+1]] holding tps
+    while(i < SHIFTMAP_POINTS-1 && tps > x[i+1])
+        ++i;
+    y0 = calib_cell(&calib, up, gear, i);
+    if(i == SHIFTMAP_POINTS-1)
+        return y0;
+
+    y1 = calib_cell(&calib, up, gear, i+1);
+    return y0 + (int32_t)((int32_t)y1 - y0)*(tps - x[i])/(x[i+1] - x[i]);
+}
+
+uint16_t shiftmap_up(uint8_t gear, uint8_t tps)
+{
+    return lookup(1, gear, tps);
+}
+
+uint16_t shiftmap_down(uint8_t gear, uint8_t tps)
+{
+    return lookup(0, gear, tps);
+}
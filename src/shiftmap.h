@@ -0,0 +1,33 @@
+/** @file
+ * @brief Gear by throttle shift map.
+ *
+ * Upshift and downshift rpm are looked up by gear and by raw throttle ADC
+ * value, with linear interpolation between the throttle breakpoints. The
+ * tables are read from flash, generated from calib/shiftmap.csv into
+ * shiftmap_table.h by tools/shiftmap_gen.c. The breakpoints and a trim per
+ * cell come from the calibration block, see calib_cell().
+ *
+ * @date    10/18/2026
+ */
+#ifndef SHIFTMAP_H
+#define SHIFTMAP_H 1
+
+#include <stdint.h>
+
+/**
+ * @brief Rpm at or above which to shift up out of @c gear.
+ *
+ * @param   gear    gear number, 1 to #MAX_GEARS
+ * @param   tps     raw throttle ADC value
+ */
+uint16_t shiftmap_up(uint8_t gear, uint8_t tps);
+
+/**
+ * @brief Rpm below which to shift down out of @c gear.
+ *
+ * @param   gear    gear number, 1 to #MAX_GEARS
+ * @param   tps     raw throttle ADC value
+ */
+uint16_t shiftmap_down(uint8_t gear, uint8_t tps);
+
+#endif /* SHIFTMAP_H */
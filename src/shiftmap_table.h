@@ -0,0 +1,36 @@
+/** @file
+ * @brief Shift map tables, generated by shiftmap_gen from ../calib/shiftmap.csv.
+ *
+ * Do not edit; change the CSV and regenerate.
+ */
+#ifndef SHIFTMAP_TABLE_H
+#define SHIFTMAP_TABLE_H 1
+
+#define SHIFTMAP_GEARS  5
+#define SHIFTMAP_POINTS 3
+#define SHIFTMAP_RPM_MAX 12000
+
+#ifdef SHIFTMAP_TABLES
+static const uint8_t shiftmap_tps[SHIFTMAP_POINTS] PROGMEM =
+    {0, 128, 255};
+
+static const uint16_t shiftmap_up_rpm[SHIFTMAP_GEARS][SHIFTMAP_POINTS] PROGMEM =
+{
+    {6000, 9000, 11500},
+    {6000, 9000, 11500},
+    {6000, 9000, 11500},
+    {6000, 9000, 11500},
+    {12000, 12000, 12000}
+};
+
+static const uint16_t shiftmap_down_rpm[SHIFTMAP_GEARS][SHIFTMAP_POINTS] PROGMEM =
+{
+    {0, 0, 0},
+    {3000, 4500, 6500},
+    {3500, 5000, 7500},
+    {4000, 5500, 8000},
+    {4000, 6000, 8500}
+};
+
+#endif /* SHIFTMAP_TABLES */
+#endif /* SHIFTMAP_TABLE_H */
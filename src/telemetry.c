@@ -0,0 +1,107 @@
+/**
+ *  @file
+ *  @brief Binary telemetry frame encoding and decoding.
+ *
+ *  @date    10/18/2026
+ */
+#include "telemetry.h"
+
+uint8_t crc8_ccitt(uint8_t crc, const uint8_t *data, uint8_t len)
+{
+    while(len--)
+    {
+        crc ^= *data++;
+        for(uint8_t i = 0; i < 8; ++i)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+uint8_t cobs_encode(const uint8_t *src, uint8_t len, uint8_t *dst)
+{
+    uint8_t code_at = 0;    // where the current block's code byte goes
+    uint8_t out = 1;
+    uint8_t code = 1;
+
+    while(len--)
+    {
+        if(*src)
+        {
+            dst[out++] = *src;
+            if(++code == 0xFF)
+            {
+                // Longest block: start a new one without an implied zero
+                dst[code_at] = code;
+                code_at = out++;
+                code = 1;
+            }
+        }else
+        {
+            dst[code_at] = code;
+            code_at = out++;
+            code = 1;
+        }
+        ++src;
+    }
+    dst[code_at] = code;
+    return out;
+}
+
+uint8_t cobs_decode(const uint8_t *src, uint8_t len, uint8_t *dst)
+{
+    uint8_t in = 0, out = 0;
+
+    while(in < len)
+    {
+        uint8_t code = src[in++];
+
+        if(code == 0 || in + code - 1 > len)
+            return 0;
+        for(uint8_t i = 1; i < code; ++i)
+            dst[out++] = src[in++];
+        if(code < 0xFF && in < len)
+            dst[out++] = 0;
+    }
+    return out;
+}
+
+uint8_t tlm_frame(const Tlm_Sample *s, uint8_t *frame)
+{
+    uint8_t raw[TLM_RAW_LEN];
+    uint8_t n;
+
+    raw[0]  = TLM_SAMPLE;
+    raw[1]  = s->seq;
+    raw[2]  = s->ms;
+    raw[3]  = s->ms >> 8;
+    raw[4]  = (s->mode << 4) | (s->gear & 0x0F);
+    raw[5]  = s->rpms;
+    raw[6]  = s->rpms >> 8;
+    raw[7]  = s->ave;
+    raw[8]  = s->ave >> 8;
+    raw[9]  = s->throttle;
+    raw[10] = s->adc;
+    raw[11] = crc8_ccitt(0, raw, TLM_PAYLOAD_LEN);
+
+    n = cobs_encode(raw, TLM_RAW_LEN, frame);
+    frame[n++] = TLM_DELIM;
+    return n;
+}
+
+uint8_t tlm_unpack(const uint8_t *raw, uint8_t len, Tlm_Sample *s)
+{
+    if(len != TLM_RAW_LEN || raw[0] != TLM_SAMPLE)
+        return 0;
+    if(crc8_ccitt(0, raw, TLM_PAYLOAD_LEN) != raw[TLM_PAYLOAD_LEN])
+        return 0;
+
+    s->seq      = raw[1];
+    s->ms       = raw[2] | (uint16_t)raw[3] << 8;
+    s->mode     = raw[4] >> 4;
+    s->gear     = raw[4] & 0x0F;
+    s->rpms     = raw[5] | (uint16_t)raw[6] << 8;
+    s->ave      = raw[7] | (uint16_t)raw[8] << 8;
+    s->throttle = raw[9];
+    s->adc      = raw[10];
+    return 1;
+}
@@ -0,0 +1,100 @@
+/** @file
+ * @brief Binary telemetry frames.
+ *
+ * A sample of the shifter state is packed into #TLM_PAYLOAD_LEN bytes,
+ * followed by a CRC-8, COBS encoded and terminated with a zero byte. The
+ * encoder and decoder share this file, so the firmware and the host tools
+ * always agree on the layout. Nothing here touches the hardware.
+ *
+ * Frame layout before encoding (multi-byte fields little-endian):
+ *  | byte | field                                   |
+ *  |------|-----------------------------------------|
+ *  | 0    | frame type, #TLM_SAMPLE                 |
+ *  | 1    | sequence number                         |
+ *  | 2-3  | timestamp (ms, wraps every 65.5 s)      |
+ *  | 4    | mode (high nibble), gear (low nibble)   |
+ *  | 5-6  | rpms                                    |
+ *  | 7-8  | average rpms                            |
+ *  | 9    | throttle position                       |
+ *  | 10   | raw throttle ADC                        |
+ *  | 11   | CRC-8 of bytes 0-10                     |
+ *
+ * @date    10/18/2026
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H 1
+
+#include <stdint.h>
+
+/** @name Telemetry Defines */
+//@{
+#define TLM_SAMPLE      0x01    ///<Frame type of a #Tlm_Sample
+#define TLM_PAYLOAD_LEN 11      ///<Bytes before the CRC
+#define TLM_RAW_LEN     (TLM_PAYLOAD_LEN+1)     ///<Payload and CRC
+#define TLM_FRAME_MAX   (TLM_RAW_LEN+2)         ///<COBS overhead and delimiter
+#define TLM_DELIM       0x00    ///<Frame delimiter
+//@}
+
+/// One telemetry sample.
+typedef struct
+{
+    uint8_t  seq;       ///< Sequence number, detects lost frames
+    uint16_t ms;        ///< Timestamp (ms)
+    uint8_t  mode;      ///< Mode of the system
+    uint8_t  gear;      ///< Current gear number
+    uint16_t rpms;      ///< Instantaneous rpms
+    uint16_t ave;       ///< Average rpms
+    uint8_t  throttle;  ///< Throttle position
+    uint8_t  adc;       ///< Raw throttle ADC value
+} Tlm_Sample;
+
+/**
+ * @brief CRC-8 (polynomial 0x07) of @c len bytes.
+ *
+ * @param   crc     initial value, 0 for a new frame
+ * @param   data    bytes to check
+ * @param   len     number of bytes
+ * @return  the updated CRC
+ */
+uint8_t crc8_ccitt(uint8_t crc, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief COBS encode @c len bytes. The delimiter is not appended.
+ *
+ * @param   src     bytes to encode
+ * @param   len     number of bytes
+ * @param   dst     output, room for @c len + 2 bytes
+ * @return  the encoded length
+ */
+uint8_t cobs_encode(const uint8_t *src, uint8_t len, uint8_t *dst);
+
+/**
+ * @brief Decode a COBS block that has had its delimiter removed.
+ *
+ * @param   src     encoded bytes
+ * @param   len     number of encoded bytes
+ * @param   dst     output, room for @c len bytes
+ * @return  the decoded length, 0 if the block is malformed
+ */
+uint8_t cobs_decode(const uint8_t *src, uint8_t len, uint8_t *dst);
+
+/**
+ * @brief Build the wire frame for @c s.
+ *
+ * @param   s       sample to send
+ * @param   frame   output, room for #TLM_FRAME_MAX bytes
+ * @return  number of bytes to transmit, delimiter included
+ */
+uint8_t tlm_frame(const Tlm_Sample *s, uint8_t *frame);
+
+/**
+ * @brief Check and unpack a decoded frame.
+ *
+ * @param   raw     COBS decoded bytes
+ * @param   len     number of decoded bytes
+ * @param   s       output sample
+ * @return  1 if the frame is a valid sample, 0 otherwise
+ */
+uint8_t tlm_unpack(const uint8_t *raw, uint8_t len, Tlm_Sample *s);
+
+#endif /* TELEMETRY_H */
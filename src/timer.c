@@ -0,0 +1,124 @@
+/**
+ *  @file
+ *  @brief Software timers on a hierarchical timing wheel.
+ *
+ *  @date    10/18/2026
+ */
+#include <string.h>
+#include "SAE_AutoShifter.h"
+#include "timer.h"
+#include "sched.h"
+#include "prof.h"
+
+#define SLOT_MASK   (TIMER_SLOTS-1)
+
+static Timer    *wheel[TIMER_LEVELS][TIMER_SLOTS];
+static uint16_t now;        ///<Last tick processed
+
+/**
+ * @brief Link @c t into the slot of its expiry time, relative to #now.
+ */
+static void place(Timer *t)
+{
+    uint16_t when = t->expires;
+    uint16_t delta = when - now;
+    uint8_t level = 0;
+    Timer **slot;
+
+    // Beyond the wheel: wait in its last slot and be placed again
+    if(delta >= TIMER_SPAN)
+    {
+        delta = TIMER_SPAN - 1;
+        when = now + delta;
+    }
+    while(delta >> (TIMER_BITS*(level+1)))
+        ++level;
+    slot = &wheel[level][(when >> (TIMER_BITS*level)) & SLOT_MASK];
+
+    t->next = *slot;
+    if(*slot)
+        (*slot)->pprev = &t->next;
+    *slot = t;
+    t->pprev = slot;
+}
+
+static void unlink(Timer *t)
+{
+    *t->pprev = t->next;
+    if(t->next)
+        t->next->pprev = t->pprev;
+    t->pprev = 0;
+}
+
+void timer_init(void)
+{
+    memset(wheel, 0, sizeof(wheel));
+    now = millis();
+}
+
+void timer_start(Timer *t, uint16_t delay, uint16_t period, Timer_Fn fn,
+                 void *arg)
+{
+    if(timer_active(t))
+        unlink(t);
+    t->expires = now + (delay ? delay : 1);
+    t->period = period;
+    t->fn = fn;
+    t->arg = arg;
+    place(t);
+}
+
+void timer_stop(Timer *t)
+{
+    if(timer_active(t))
+        unlink(t);
+}
+
+uint16_t timer_now(void)
+{
+    return now;
+}
+
+void timer_tick(void)
+{
+    sched_post(TASK_TIMER);
+}
+
+void timer_run(void)
+{
+    uint16_t until = millis();
+
+    PROF_BEGIN(PROF_TIMERS);
+    while(now != until)
+    {
+        Timer *t;
+
+        ++now;
+        // Move the slot each upper level has come round to down the wheel
+        for(uint8_t level = 1; level < TIMER_LEVELS &&
+            !(now & ((1 << (TIMER_BITS*level)) - 1)); ++level)
+        {
+            Timer **slot = &wheel[level][(now >> (TIMER_BITS*level)) &
+                                         SLOT_MASK];
+
+            while((t = *slot))
+            {
+                unlink(t);
+                place(t);
+            }
+        }
+
+        // A callback may start or stop any timer, this slot's included
+        while((t = wheel[0][now & SLOT_MASK]))
+        {
+            unlink(t);
+            if(t->period)
+            {
+                t->expires = now + t->period;
+                place(t);
+            }
+            t->fn(t->arg);
+        }
+    }
+    PROF_END(PROF_TIMERS);
+}
@@ -0,0 +1,105 @@
+/** @file
+ * @brief Software timers on a hierarchical timing wheel.
+ *
+ * Every periodic or delayed job runs on one hardware tick: the
+ * #TIMER0_FREQ interrupt calls timer_tick(), which only posts #TASK_TIMER.
+ * The timers expire and their callbacks run in timer_run(), in main
+ * context, so a callback may take its time, use the serial port and start
+ * or stop timers, including its own.
+ *
+ * The wheel has #TIMER_LEVELS levels of #TIMER_SLOTS slots. Level 0 holds
+ * timers due within #TIMER_SLOTS ms, one slot per ms; each level above is
+ * #TIMER_SLOTS times coarser. A timer goes in the slot of its expiry time
+ * at the lowest level that reaches it, and moves down a level each time
+ * the level below wraps around to its slot. Each slot is a doubly linked
+ * list, so starting and stopping a timer are O(1), and a tick does work
+ * only for the timers that expire or move on it. Timers further away than
+ * the wheel spans wait in its last slot and are placed again from there.
+ *
+ * Time is the low 16 bits of millis(). If the main task falls behind,
+ * timer_run() catches up tick by tick, so timers expire in order and each
+ * sees timer_now() as its own expiry time. A periodic timer is restarted
+ * from that expiry time, so it keeps its phase however late it runs.
+ *
+ * @date    10/18/2026
+ */
+#ifndef TIMER_H
+#define TIMER_H 1
+
+#include <stdint.h>
+
+/** @name Timer Wheel Defines */
+//@{
+#define TIMER_BITS      4   ///<log2 of the slots per level
+#define TIMER_SLOTS     (1 << TIMER_BITS)   ///<Slots per level
+#define TIMER_LEVELS    3   ///<Levels of the wheel
+#define TIMER_SPAN      (1UL << (TIMER_BITS*TIMER_LEVELS))  ///<Reach (ms)
+#define TIMER_MAX_MS    0x7FFF  ///<Longest delay or period (ms)
+//@}
+
+/// Timer callback. @c arg is the value given to timer_start().
+typedef void (*Timer_Fn)(void *arg);
+
+/// One software timer. Owned by the caller; the wheel only links it.
+typedef struct Timer
+{
+    struct Timer  *next;    ///< Next in the slot
+    struct Timer  **pprev;  ///< Link pointing at this one, 0 when stopped
+    uint16_t      expires;  ///< Expiry time (ms)
+    uint16_t      period;   ///< Restart interval (ms), 0 for one-shot
+    Timer_Fn      fn;       ///< Callback
+    void          *arg;     ///< Its argument
+} Timer;
+
+/**
+ * @brief Empty the wheel and start its clock at millis().
+ */
+void timer_init(void);
+
+/**
+ * @brief Start or restart @c t.
+ *
+ * @param   t       timer, stopped or running
+ * @param   delay   ms to the first expiry, 1 to #TIMER_MAX_MS; 0 counts
+ *                  as 1, the next tick
+ * @param   period  ms between later expiries, 0 for a one-shot
+ * @param   fn      callback
+ * @param   arg     its argument
+ *
+ * Main context only.
+ */
+void timer_start(Timer *t, uint16_t delay, uint16_t period, Timer_Fn fn,
+                 void *arg);
+
+/**
+ * @brief Stop @c t if it is running. Main context only.
+ */
+void timer_stop(Timer *t);
+
+/**
+ * @return 1 while @c t is waiting to expire
+ */
+static inline uint8_t timer_active(const Timer *t)
+{
+    return t->pprev != 0;
+}
+
+/**
+ * @return the time the wheel has reached (ms); inside a callback, the
+ *         expiry time of its timer
+ */
+uint16_t timer_now(void);
+
+/**
+ * @brief Hardware tick: have #TASK_TIMER run the wheel.
+ *
+ * Called from ISR(TIMER0_COMPA_vect) after #sys_ms is advanced.
+ */
+void timer_tick(void);
+
+/**
+ * @brief #TASK_TIMER: expire the timers due up to millis().
+ */
+void timer_run(void);
+
+#endif /* TIMER_H */
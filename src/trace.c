@@ -0,0 +1,101 @@
+/**
+ *  @file
+ *  @brief Input traces for recording and replaying sessions on the host.
+ *
+ *  @date    10/18/2026
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define LINE_MAX_LEN    80  ///<Longest trace line
+
+static const char *const name[TRACE_CHANNELS] =
+    {"tach", "tps", "up", "dn", "mode", "shift"};
+
+void trace_write(FILE *f, const Trace_Event *ev)
+{
+    fprintf(f, "%" PRIu64 " %s %d\n", ev->us, name[ev->ch], ev->value);
+}
+
+int trace_read(FILE *f, Trace_Event *ev)
+{
+    char line[LINE_MAX_LEN], ch[8];
+    uint64_t prev = ev->us;
+    int value;
+
+    while(fgets(line, sizeof(line), f))
+    {
+        uint8_t i = 0;
+
+        if(line[0] == '#' || line[0] == '\n')
+            continue;
+        if(sscanf(line, "%" SCNu64 " %7s %d", &ev->us, ch, &value) != 3)
+            return -1;
+        while(i < TRACE_CHANNELS && strcmp(ch, name[i]))
+            ++i;
+        if(i == TRACE_CHANNELS || ev->us < prev)
+            return -1;
+        ev->ch = i;
+        ev->value = value;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Note an unmatched shift at @c us.
+ */
+static void unmatched(Trace_Result *r, uint64_t us)
+{
+    if(r->first_us < 0 || (int64_t)us < r->first_us)
+        r->first_us = us;
+}
+
+void trace_compare(const Trace_Event *recorded, unsigned n_recorded,
+                   const Trace_Event *replayed, unsigned n_replayed,
+                   uint32_t window_us, Trace_Result *r)
+{
+    uint8_t *used = calloc(n_replayed ? n_replayed : 1, 1);
+    unsigned from = 0;
+
+    memset(r, 0, sizeof(*r));
+    r->first_us = -1;
+    r->recorded = n_recorded;
+    r->replayed = n_replayed;
+
+    for(unsigned i = 0; i < n_recorded; ++i)
+    {
+        uint64_t t = recorded[i].us;
+        unsigned j;
+
+        // Replayed shifts too early for this one are too early for the rest
+        while(from < n_replayed && replayed[from].us + window_us < t)
+            ++from;
+        for(j = from; j < n_replayed && replayed[j].us <= t + window_us; ++j)
+            if(!used[j] && replayed[j].value == recorded[i].value)
+                break;
+        if(j < n_replayed && replayed[j].us <= t + window_us)
+        {
+            int64_t d = (int64_t)(replayed[j].us - t);
+
+            used[j] = 1;
+            ++r->matched;
+            r->delta_sum += d;
+            if(llabs(d) > llabs(r->delta_max))
+                r->delta_max = d;
+        }else
+        {
+            ++r->missing;
+            unmatched(r, t);
+        }
+    }
+    for(unsigned j = 0; j < n_replayed; ++j)
+        if(!used[j])
+        {
+            ++r->extra;
+            unmatched(r, replayed[j].us);
+        }
+    free(used);
+}
@@ -0,0 +1,94 @@
+/** @file
+ * @brief Input traces for recording and replaying sessions on the host.
+ *
+ * A trace is the inputs of one session, as the controller saw them, and
+ * the shifts it made: one event per line, in time order,
+ *
+ *     <us> <channel> <value>
+ *
+ * where @c us is the time since boot in microseconds and the channels are
+ *  | channel | value                                                     |
+ *  |---------|-----------------------------------------------------------|
+ *  | tach    | a tachometer edge (value unused)                          |
+ *  | tps     | gas pedal input, ADC counts 0 to 1023                     |
+ *  | up      | upshift paddle: 1 pressed, 0 released                     |
+ *  | dn      | downshift paddle: 1 pressed, 0 released                   |
+ *  | mode    | mode switch, as #Mode: 0 manual, 1 semi-auto, 2 automated |
+ *  | shift   | a shift the controller made: 1 up, -1 down                |
+ *
+ * The inputs other than tach are sampled once a millisecond, and written
+ * only when they change. Lines starting with '#' are comments.
+ *
+ * trace_compare() matches the shifts of a replay against the recorded
+ * ones.
+ *
+ * Host only.
+ *
+ * @date    10/18/2026
+ */
+#ifndef TRACE_H
+#define TRACE_H 1
+
+#include <stdint.h>
+#include <stdio.h>
+
+/// Trace channels.
+typedef enum
+{
+    TRACE_TACH,
+    TRACE_TPS,
+    TRACE_UP,
+    TRACE_DN,
+    TRACE_MODE,
+    TRACE_SHIFT,
+    TRACE_CHANNELS
+} Trace_Channel;
+
+/// One line of a trace.
+typedef struct
+{
+    uint64_t us;        ///< Time since boot (us)
+    uint8_t  ch;        ///< #Trace_Channel
+    int16_t  value;
+} Trace_Event;
+
+/// Shifts of a replay compared with the recorded ones.
+typedef struct
+{
+    unsigned recorded;  ///< Shifts in the trace
+    unsigned replayed;  ///< Shifts in the replay
+    unsigned matched;   ///< Same direction, within the window
+    unsigned missing;   ///< Recorded, not replayed
+    unsigned extra;     ///< Replayed, not recorded
+    int64_t  first_us;  ///< First shift that did not match, -1 if none
+    int64_t  delta_sum; ///< Sum of replayed minus recorded time (us)
+    int64_t  delta_max; ///< Largest of them, by magnitude (us)
+} Trace_Result;
+
+/**
+ * @brief Write @c ev as one trace line.
+ */
+void trace_write(FILE *f, const Trace_Event *ev);
+
+/**
+ * @brief Read the next event, skipping comments and blank lines.
+ *
+ * @c ev holds the event read before, zeroed for the first one.
+ *
+ * @return 1 for an event, 0 at the end of the file, -1 on a line that is
+ *         not an event or is earlier than the one before
+ */
+int trace_read(FILE *f, Trace_Event *ev);
+
+/**
+ * @brief Match @c replayed shift events against @c recorded ones.
+ *
+ * Both are #TRACE_SHIFT events in time order. Each recorded shift matches
+ * the earliest unmatched replayed shift in the same direction no more than
+ * @c window_us away.
+ */
+void trace_compare(const Trace_Event *recorded, unsigned n_recorded,
+                   const Trace_Event *replayed, unsigned n_replayed,
+                   uint32_t window_us, Trace_Result *r);
+
+#endif /* TRACE_H */
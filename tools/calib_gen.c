@@ -0,0 +1,150 @@
+/**
+ *  @file
+ *  @brief Write an EEPROM calibration image.
+ *
+ *  Starts from the compiled-in defaults, that is the shift map generated
+ *  from calib/shiftmap.csv and the timing defines in defines.h, applies any
+ *  overrides given on the command line, checks the result and writes the
+ *  calibration block of calib.h with its version and CRC filled in.
+ *
+ *  Usage: calib_gen [-i ign_ms] [-s solen_ms] [-S settle_ms] [-d db_ms]
+ *                   [-p pulse_rot] [-e engage_ms] [-l lead_pct[,...]]
+ *                   [-L lead_max] [-b] > image
+ *   - @c -l sets the upshift lead of each gear in turn, from first gear;
+ *     a single value sets every gear
+ *   - without @c -b the image is Intel HEX, for
+ *     avrdude -U eeprom:w:image:i
+ *   - with @c -b it is raw binary, for SAE_AutoShifter_host -e
+ *
+ *  @date    10/18/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "calib.h"
+
+#define HEX_LINE    16  ///<Data bytes per Intel HEX record
+
+static unsigned long num_arg(const char *opt, const char *arg,
+                             unsigned long min, unsigned long max)
+{
+    char *end;
+    unsigned long v = strtoul(arg, &end, 0);
+
+    if(end == arg || *end || v < min || v > max)
+    {
+        fprintf(stderr, "-%s: expected %lu-%lu, got '%s'\n", opt, min, max,
+                arg);
+        exit(1);
+    }
+    return v;
+}
+
+static uint8_t byte_arg(const char *opt, const char *arg)
+{
+    return num_arg(opt, arg, 1, 255);
+}
+
+/**
+ * @brief Parse the per gear upshift leads of @c -l into @c c.
+ */
+static void lead_arg(Calib *c, char *arg)
+{
+    unsigned g = 0;
+
+    for(char *v = strtok(arg, ","); v; v = strtok(0, ","))
+    {
+        if(g == SHIFTMAP_GEARS)
+        {
+            fprintf(stderr, "-l: more than %u gears\n", SHIFTMAP_GEARS);
+            exit(1);
+        }
+        c->lead_pct[g++] = num_arg("l", v, 0, SHIFT_LEAD_PCT_MAX);
+    }
+    // One value for every gear
+    if(g == 1)
+        memset(c->lead_pct, c->lead_pct[0], sizeof(c->lead_pct));
+}
+
+static void write_hex(const uint8_t *data, unsigned len, unsigned addr)
+{
+    for(unsigned i = 0; i < len; i += HEX_LINE)
+    {
+        unsigned n = len - i < HEX_LINE ? len - i : HEX_LINE;
+        unsigned a = addr + i;
+        uint8_t sum = n + (a >> 8) + a;
+
+        printf(":%02X%04X00", n, a);
+        for(unsigned j = 0; j < n; ++j)
+        {
+            printf("%02X", data[i+j]);
+            sum += data[i+j];
+        }
+        printf("%02X\n", (uint8_t)-sum);
+    }
+    printf(":00000001FF\n");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-i ign_ms] [-s solen_ms] [-S settle_ms] "
+            "[-d db_ms] [-p pulse_rot] [-e engage_ms] [-l lead_pct[,...]] "
+            "[-L lead_max] [-b]\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    Calib c;
+    int opt, binary = 0;
+
+    calib_defaults(&c);
+    while((opt = getopt(argc, argv, "i:s:S:d:p:e:l:L:b")) != -1)
+    {
+        switch(opt)
+        {
+            case 'i':
+                c.ign_ms = byte_arg("i", optarg);
+                break;
+            case 's':
+                c.solen_ms = byte_arg("s", optarg);
+                break;
+            case 'S':
+                c.settle_ms = byte_arg("S", optarg);
+                break;
+            case 'd':
+                c.db_ms = byte_arg("d", optarg);
+                break;
+            case 'p':
+                c.pulse_rot = byte_arg("p", optarg);
+                break;
+            case 'e':
+                c.engage_ms = num_arg("e", optarg, 0, 255);
+                break;
+            case 'l':
+                lead_arg(&c, optarg);
+                break;
+            case 'L':
+                c.lead_max = num_arg("L", optarg, 0, 65535);
+                break;
+            case 'b':
+                binary = 1;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    c.crc = calib_crc(&c);
+    if(!calib_valid(&c))
+    {
+        fprintf(stderr, "%s: calibration does not validate\n", argv[0]);
+        return 1;
+    }
+
+    if(binary)
+        fwrite(&c, sizeof(c), 1, stdout);
+    else
+        write_hex((const uint8_t *)&c, sizeof(c), CALIB_EE_ADDR);
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ *  @file
+ *  @brief Host check of the rpm filter pipeline, run by make check.
+ *
+ *  Feeds rpm_filter.c a steady engine followed by a stall, as the
+ *  tachometer code does, and exits non-zero if any filtered rpm is left
+ *  above 0.
+ *
+ *  @date    10/18/2026
+ */
+#include <stdio.h>
+#include "rpm_filter.h"
+
+#define PERIOD_US   2500    ///<Time between samples
+
+int main(void)
+{
+    Rpm_Filter f = {0};
+    uint32_t us = 0;
+
+    for(int i = 0; i < 50; ++i)
+        rpm_filter_update(&f, 8000, us += PERIOD_US);
+
+    // Stall, as tach_record() handles a 0 sample
+    rpm_filter_reset(&f);
+    rpm_filter_update(&f, 0, us += PERIOD_US);
+
+    printf("median=%u ave=%u ema=%u slope=%d\n", f.median, f.ave, f.ema,
+           f.slope);
+    if(f.median || f.ave || f.ema || f.slope)
+    {
+        fprintf(stderr, "rpm_filter_test: rpm held after a stall\n");
+        return 1;
+    }
+
+    // Restarting from 0 works as from boot
+    for(int i = 0; i < 50; ++i)
+        rpm_filter_update(&f, 8000, us += PERIOD_US);
+    if(f.median != 8000 || f.ave != 8000)
+    {
+        fprintf(stderr, "rpm_filter_test: no recovery after a stall\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ *  @file
+ *  @brief Generate the flash shift map from a CSV calibration.
+ *
+ *  Reads rows of @c gear,throttle,up,down (see calib/shiftmap.csv), checks
+ *  that every gear has the same increasing throttle breakpoints, that
+ *  each downshift point lies below its upshift point and that neither
+ *  falls as the throttle opens, then writes the PROGMEM tables and the
+ *  highest upshift rpm for config.h to check against the rev limit. The
+ *  table dimensions are always defined; the tables themselves only where
+ *  @c SHIFTMAP_TABLES is defined first, so exactly one file holds them.
+ *
+ *  Usage: shiftmap_gen calibration.csv > shiftmap_table.h
+ *
+ *  @date    10/18/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define MAX_GEAR    15  ///<Gear numbers fit in a nibble of telemetry
+#define MAX_POINTS  32  ///<Breakpoints per gear
+
+static unsigned tps[MAX_GEAR][MAX_POINTS];
+static unsigned up[MAX_GEAR][MAX_POINTS];
+static unsigned dn[MAX_GEAR][MAX_POINTS];
+static unsigned points[MAX_GEAR];
+
+static void fail(const char *file, unsigned line, const char *msg)
+{
+    fprintf(stderr, "%s:%u: %s\n", file, line, msg);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned gears = 0, line = 0, rpm_max = 0;
+    char buf[256];
+    FILE *in;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s calibration.csv\n", argv[0]);
+        return 1;
+    }
+    if(!(in = fopen(argv[1], "r")))
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while(fgets(buf, sizeof(buf), in))
+    {
+        unsigned g, t, u, d, n;
+        char *p = buf;
+
+        ++line;
+        while(isspace((unsigned char)*p))
+            ++p;
+        if(*p == '#' || *p == '\0')
+            continue;
+        if(sscanf(p, "%u,%u,%u,%u", &g, &t, &u, &d) != 4)
+            fail(argv[1], line, "expected gear,throttle,up,down");
+        if(g < 1 || g > MAX_GEAR)
+            fail(argv[1], line, "gear out of range");
+        if(t > 255)
+            fail(argv[1], line, "throttle must be 0-255");
+        if(u > 65535 || d > 65535)
+            fail(argv[1], line, "rpm must fit in 16 bits");
+        if(d >= u)
+            fail(argv[1], line, "down must be below up");
+
+        n = points[g-1];
+        if(n == MAX_POINTS)
+            fail(argv[1], line, "too many breakpoints");
+        if(n && t <= tps[g-1][n-1])
+            fail(argv[1], line, "breakpoints must increase");
+        if(n && (u < up[g-1][n-1] || d < dn[g-1][n-1]))
+            fail(argv[1], line, "shift points must not fall with throttle");
+        tps[g-1][n] = t;
+        up[g-1][n] = u;
+        dn[g-1][n] = d;
+        points[g-1] = n+1;
+        if(g > gears)
+            gears = g;
+        if(u > rpm_max)
+            rpm_max = u;
+    }
+    fclose(in);
+
+    if(gears == 0)
+        fail(argv[1], line, "no rows");
+    for(unsigned g = 0; g < gears; ++g)
+    {
+        if(points[g] != points[0])
+            fail(argv[1], line, "every gear needs the same breakpoints");
+        for(unsigned i = 0; i < points[g]; ++i)
+            if(tps[g][i] != tps[0][i])
+                fail(argv[1], line, "every gear needs the same breakpoints");
+    }
+
+    printf("/** @file\n"
+           " * @brief Shift map tables, generated by shiftmap_gen from %s.\n"
+           " *\n"
+           " * Do not edit; change the CSV and regenerate.\n"
+           " */\n", argv[1]);
+    printf("#ifndef SHIFTMAP_TABLE_H\n#define SHIFTMAP_TABLE_H 1\n\n");
+    printf("#define SHIFTMAP_GEARS  %u\n", gears);
+    printf("#define SHIFTMAP_POINTS %u\n", points[0]);
+    printf("#define SHIFTMAP_RPM_MAX %u\n\n", rpm_max);
+    printf("#ifdef SHIFTMAP_TABLES\n");
+
+    printf("static const uint8_t shiftmap_tps[SHIFTMAP_POINTS] PROGMEM =\n"
+           "    {");
+    for(unsigned i = 0; i < points[0]; ++i)
+        printf("%s%u", i ? ", " : "", tps[0][i]);
+    printf("};\n\n");
+
+    for(int table = 0; table < 2; ++table)
+    {
+        unsigned (*v)[MAX_POINTS] = table ? dn : up;
+
+        printf("static const uint16_t shiftmap_%s_rpm"
+               "[SHIFTMAP_GEARS][SHIFTMAP_POINTS] PROGMEM =\n{\n",
+               table ? "down" : "up");
+        for(unsigned g = 0; g < gears; ++g)
+        {
+            printf("    {");
+            for(unsigned i = 0; i < points[g]; ++i)
+                printf("%s%u", i ? ", " : "", v[g][i]);
+            printf("}%s\n", g+1 < gears ? "," : "");
+        }
+        printf("};\n\n");
+    }
+    printf("#endif /* SHIFTMAP_TABLES */\n");
+    printf("#endif /* SHIFTMAP_TABLE_H */\n");
+    return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ *  @file
+ *  @brief Columnar session log.
+ *
+ *  @date    10/18/2026
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "slog.h"
+
+#define MAGIC       "SLOG"
+#define HEADER_LEN  16                      ///<magic, version, columns, rows
+#define BLOCK_HEAD  (4 + 4*SLOG_COLUMNS)    ///<rows, column lengths
+#define INDEX_LEN   20                      ///<offset, rows, first, last ms
+#define FOOTER_LEN  16                      ///<index offset, blocks, magic
+#define VARINT_MAX  5                       ///<Longest 32 bit varint
+
+const char *const slog_column_name[SLOG_COLUMNS] =
+    {"ms", "rpm", "gear", "mode", "throttle", "shift"};
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    while(bytes--)
+    {
+        *p++ = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+static uint64_t get_le(const uint8_t *p, int bytes)
+{
+    uint64_t v = 0;
+
+    while(bytes--)
+        v = v << 8 | p[bytes];
+    return v;
+}
+
+/**
+ * @brief Write @c v, zigzag mapped, as a varint at @c p.
+ *
+ * @return the bytes written
+ */
+static int put_varint(uint8_t *p, int32_t v)
+{
+    uint32_t z = (uint32_t)v << 1 ^ (uint32_t)(v >> 31);
+    int n = 0;
+
+    while(z >= 0x80)
+    {
+        p[n++] = z | 0x80;
+        z >>= 7;
+    }
+    p[n++] = z;
+    return n;
+}
+
+/**
+ * @brief Read a varint from @c *p, no further than @c end.
+ *
+ * @return 0 if it runs past @c end or is too long
+ */
+static int get_varint(const uint8_t **p, const uint8_t *end, int32_t *v)
+{
+    uint32_t z = 0;
+
+    for(int shift = 0; *p < end && shift < 7*VARINT_MAX; shift += 7)
+    {
+        uint8_t b = *(*p)++;
+
+        z |= (uint32_t)(b & 0x7F) << shift;
+        if(!(b & 0x80))
+        {
+            *v = (int32_t)(z >> 1 ^ -(z & 1));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int write_all(Slog_Writer *w, const void *buf, size_t len)
+{
+    if(fwrite(buf, 1, len, w->f) != len)
+        return -1;
+    w->offset += len;
+    return 0;
+}
+
+/**
+ * @brief Encode the open block and add it to the index.
+ */
+static int flush_block(Slog_Writer *w)
+{
+    static uint8_t col[SLOG_COLUMNS][SLOG_BLOCK_ROWS*VARINT_MAX];
+    uint8_t head[BLOCK_HEAD];
+    uint32_t len[SLOG_COLUMNS];
+    Slog_Block *b;
+
+    if(!w->n)
+        return 0;
+    if(w->blocks == w->cap)
+    {
+        uint32_t cap = w->cap ? 2*w->cap : 64;
+        Slog_Block *index = realloc(w->index, cap*sizeof(*index));
+
+        if(!index)
+            return -1;
+        w->index = index;
+        w->cap = cap;
+    }
+    b = &w->index[w->blocks++];
+    b->offset   = w->offset;
+    b->rows     = w->n;
+    b->first_ms = w->rows[0].v[SLOG_MS];
+    b->last_ms  = w->rows[w->n-1].v[SLOG_MS];
+
+    put_le(head, w->n, 4);
+    for(int c = 0; c < SLOG_COLUMNS; ++c)
+    {
+        int32_t prev = 0;
+
+        len[c] = 0;
+        for(uint32_t i = 0; i < w->n; ++i)
+        {
+            int32_t v = w->rows[i].v[c];
+
+            len[c] += put_varint(col[c] + len[c], (int32_t)((uint32_t)v -
+                                                            (uint32_t)prev));
+            prev = v;
+        }
+        put_le(head + 4 + 4*c, len[c], 4);
+    }
+    if(write_all(w, head, sizeof(head)))
+        return -1;
+    for(int c = 0; c < SLOG_COLUMNS; ++c)
+        if(write_all(w, col[c], len[c]))
+            return -1;
+    w->n = 0;
+    return 0;
+}
+
+int slog_create(Slog_Writer *w, const char *path)
+{
+    uint8_t head[HEADER_LEN];
+
+    memset(w, 0, sizeof(*w));
+    if(!(w->f = fopen(path, "wb")))
+        return -1;
+    memcpy(head, MAGIC, 4);
+    put_le(head + 4, SLOG_VERSION, 4);
+    put_le(head + 8, SLOG_COLUMNS, 4);
+    put_le(head + 12, SLOG_BLOCK_ROWS, 4);
+    return write_all(w, head, sizeof(head));
+}
+
+int slog_append(Slog_Writer *w, const Slog_Row *row)
+{
+    w->rows[w->n++] = *row;
+    return w->n == SLOG_BLOCK_ROWS ? flush_block(w) : 0;
+}
+
+int slog_close(Slog_Writer *w)
+{
+    uint8_t entry[INDEX_LEN], foot[FOOTER_LEN];
+    uint64_t index = 0;
+    int err = flush_block(w);
+
+    if(!err)
+    {
+        index = w->offset;
+        for(uint32_t i = 0; i < w->blocks && !err; ++i)
+        {
+            put_le(entry, w->index[i].offset, 8);
+            put_le(entry + 8, w->index[i].rows, 4);
+            put_le(entry + 12, w->index[i].first_ms, 4);
+            put_le(entry + 16, w->index[i].last_ms, 4);
+            err = write_all(w, entry, sizeof(entry));
+        }
+    }
+    if(!err)
+    {
+        put_le(foot, index, 8);
+        put_le(foot + 8, w->blocks, 4);
+        memcpy(foot + 12, MAGIC, 4);
+        err = write_all(w, foot, sizeof(foot));
+    }
+    if(fclose(w->f))
+        err = -1;
+    free(w->index);
+    w->index = NULL;
+    return err;
+}
+
+/**
+ * @brief Fail slog_open() with @c why.
+ */
+static int bad_file(Slog_Reader *r, const char *path, const char *why)
+{
+    snprintf(r->err, sizeof(r->err), "%s: %s", path, why);
+    slog_unmap(r);
+    return -1;
+}
+
+int slog_open(Slog_Reader *r, const char *path)
+{
+    struct stat st;
+    const uint8_t *foot;
+    uint64_t index;
+    void *map;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    if((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st))
+    {
+        snprintf(r->err, sizeof(r->err), "%s: %s", path, strerror(errno));
+        if(fd >= 0)
+            close(fd);
+        return -1;
+    }
+    if((size_t)st.st_size < HEADER_LEN + FOOTER_LEN)
+    {
+        close(fd);
+        return bad_file(r, path, "too short for a session log");
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return bad_file(r, path, strerror(errno));
+    r->map = map;
+    r->size = st.st_size;
+    // Decoding walks the blocks forwards
+    madvise(map, r->size, MADV_SEQUENTIAL);
+
+    foot = r->map + r->size - FOOTER_LEN;
+    if(memcmp(r->map, MAGIC, 4) || memcmp(foot + 12, MAGIC, 4))
+        return bad_file(r, path, "not a session log, or cut short");
+    if(get_le(r->map + 4, 4) != SLOG_VERSION ||
+       get_le(r->map + 8, 4) != SLOG_COLUMNS ||
+       get_le(r->map + 12, 4) != SLOG_BLOCK_ROWS)
+        return bad_file(r, path, "unsupported version or layout");
+
+    index = get_le(foot, 8);
+    r->blocks = get_le(foot + 8, 4);
+    if(index < HEADER_LEN || index > r->size - FOOTER_LEN ||
+       (r->size - FOOTER_LEN - index) != (uint64_t)r->blocks*INDEX_LEN)
+        return bad_file(r, path, "corrupt block index");
+    r->index = r->map + index;
+    return 0;
+}
+
+void slog_unmap(Slog_Reader *r)
+{
+    if(r->map)
+        munmap((void *)r->map, r->size);
+    r->map = NULL;
+    r->index = NULL;
+    r->blocks = 0;
+}
+
+Slog_Block slog_block(const Slog_Reader *r, uint32_t i)
+{
+    const uint8_t *p = r->index + (size_t)i*INDEX_LEN;
+    Slog_Block b;
+
+    b.offset   = get_le(p, 8);
+    b.rows     = get_le(p + 8, 4);
+    b.first_ms = get_le(p + 12, 4);
+    b.last_ms  = get_le(p + 16, 4);
+    return b;
+}
+
+uint32_t slog_find(const Slog_Reader *r, uint32_t ms)
+{
+    uint32_t lo = 0, hi = r->blocks;
+
+    while(lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo)/2;
+
+        if(slog_block(r, mid).last_ms < ms)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+long slog_decode(const Slog_Reader *r, uint32_t i, unsigned mask,
+                 int32_t *out[SLOG_COLUMNS])
+{
+    Slog_Block b = slog_block(r, i);
+    const uint8_t *p, *col, *end = r->map + r->size;
+
+    if(b.offset < HEADER_LEN || b.offset > r->size - BLOCK_HEAD)
+        return -1;
+    p = r->map + b.offset;
+    if(get_le(p, 4) != b.rows || b.rows > SLOG_BLOCK_ROWS)
+        return -1;
+
+    // The column lengths let unwanted columns be skipped unread
+    col = p + BLOCK_HEAD;
+    for(int c = 0; c < SLOG_COLUMNS; ++c)
+    {
+        uint32_t len = get_le(p + 4 + 4*c, 4);
+        const uint8_t *q = col, *stop = col + len;
+        int32_t v = 0, d;
+
+        if(len > (size_t)(end - col))
+            return -1;
+        col = stop;
+        if(!(mask & 1u << c))
+            continue;
+        for(uint32_t n = 0; n < b.rows; ++n)
+        {
+            if(!get_varint(&q, stop, &d))
+                return -1;
+            v = (int32_t)((uint32_t)v + (uint32_t)d);
+            out[c][n] = v;
+        }
+    }
+    return b.rows;
+}
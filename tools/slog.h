@@ -0,0 +1,149 @@
+/** @file
+ * @brief Columnar session log.
+ *
+ * Long telemetry sessions are archived in a host file that stores each
+ * channel as its own column, so a reader only touches the channels it
+ * asks for. Rows are grouped into blocks of up to #SLOG_BLOCK_ROWS. Within
+ * a block every column is delta encoded from the row before it, starting
+ * from 0, zigzag mapped and written as LEB128 varints; slowly changing
+ * channels such as gear and mode take one byte a row. Each block decodes
+ * on its own, and a block index at the end of the file gives the offset
+ * and time span of every block.
+ *
+ * The reader memory-maps the file and decodes only the blocks that overlap
+ * the requested time range and, in them, only the requested columns, so
+ * archives of many gigabytes are read without loading them.
+ *
+ * File layout, every integer little-endian:
+ *  | part   | contents                                                  |
+ *  |--------|-----------------------------------------------------------|
+ *  | header | magic "SLOG", version, columns, block rows (uint32 each)  |
+ *  | block  | rows, byte length of each column (uint32), column data    |
+ *  | ...    |                                                           |
+ *  | index  | per block: offset (uint64), rows, first ms, last ms       |
+ *  | footer | index offset (uint64), blocks (uint32), magic "SLOG"      |
+ *
+ * Host only.
+ *
+ * @date    10/18/2026
+ */
+#ifndef SLOG_H
+#define SLOG_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SLOG_VERSION    1
+#define SLOG_BLOCK_ROWS 4096    ///<Rows per block
+#define SLOG_ERR_LEN    128     ///<Room for an error message
+
+/// Channels, in file order.
+typedef enum
+{
+    SLOG_MS,            ///< Timestamp (ms), never decreasing
+    SLOG_RPM,           ///< Engine rpm
+    SLOG_GEAR,          ///< Gear number
+    SLOG_MODE,          ///< Mode of the system
+    SLOG_THROTTLE,      ///< Throttle position
+    SLOG_SHIFT,         ///< Gear change since the row before, 0 if none
+    SLOG_COLUMNS
+} Slog_Column;
+
+extern const char *const slog_column_name[SLOG_COLUMNS];
+
+/// One row: a value per #Slog_Column.
+typedef struct
+{
+    int32_t v[SLOG_COLUMNS];
+} Slog_Row;
+
+/// Index entry of one block.
+typedef struct
+{
+    uint64_t offset;    ///< File offset of the block
+    uint32_t rows;      ///< Rows in the block
+    uint32_t first_ms;  ///< Timestamp of the first row
+    uint32_t last_ms;   ///< Timestamp of the last row
+} Slog_Block;
+
+/// Log being written.
+typedef struct
+{
+    FILE       *f;
+    uint64_t   offset;                      ///< Bytes written so far
+    Slog_Row   rows[SLOG_BLOCK_ROWS];       ///< Rows of the open block
+    uint32_t   n;                           ///< Rows in the open block
+    Slog_Block *index;                      ///< Blocks written
+    uint32_t   blocks;
+    uint32_t   cap;                         ///< Room in @c index
+} Slog_Writer;
+
+/// Log opened for reading.
+typedef struct
+{
+    const uint8_t *map;     ///< The whole file, memory-mapped
+    size_t        size;
+    uint32_t      blocks;   ///< Number of blocks
+    const uint8_t *index;   ///< Index entries in the mapping
+    char          err[SLOG_ERR_LEN];    ///< Why slog_open() failed
+} Slog_Reader;
+
+/**
+ * @brief Create @c path and write the header.
+ *
+ * @return 0, or -1 with errno set
+ */
+int slog_create(Slog_Writer *w, const char *path);
+
+/**
+ * @brief Append a row. Timestamps must not decrease.
+ *
+ * @return 0, or -1 on a write error
+ */
+int slog_append(Slog_Writer *w, const Slog_Row *row);
+
+/**
+ * @brief Write the last block, the index and the footer, and close.
+ *
+ * @return 0, or -1 on a write error
+ */
+int slog_close(Slog_Writer *w);
+
+/**
+ * @brief Map @c path and check its header, index and footer.
+ *
+ * @return 0, or -1 with the reason in @c r->err
+ */
+int slog_open(Slog_Reader *r, const char *path);
+
+/**
+ * @brief Unmap a log opened with slog_open().
+ */
+void slog_unmap(Slog_Reader *r);
+
+/**
+ * @brief Index entry of block @c i.
+ */
+Slog_Block slog_block(const Slog_Reader *r, uint32_t i);
+
+/**
+ * @brief First block whose last row is at or after @c ms.
+ *
+ * @return the block, or @c r->blocks if every row is earlier
+ */
+uint32_t slog_find(const Slog_Reader *r, uint32_t ms);
+
+/**
+ * @brief Decode the columns of block @c i selected by @c mask.
+ *
+ * Bit @c c of @c mask selects column @c c, which is decoded into
+ * @c out[c], room for #SLOG_BLOCK_ROWS values. Other columns are skipped
+ * without being read.
+ *
+ * @return the number of rows, or -1 if the block is corrupt
+ */
+long slog_decode(const Slog_Reader *r, uint32_t i, unsigned mask,
+                 int32_t *out[SLOG_COLUMNS]);
+
+#endif /* SLOG_H */
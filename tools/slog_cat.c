@@ -0,0 +1,155 @@
+/**
+ *  @file
+ *  @brief Print part of a columnar session log as CSV.
+ *
+ *  Usage: slog_cat [-c column[,column...]] [-f ms] [-u ms] [-i] log
+ *   - @c -c  columns to print, in file order; all of them by default.
+ *            Names as in #slog_column_name: ms, rpm, gear, mode, throttle,
+ *            shift
+ *   - @c -f  first timestamp to print (ms)
+ *   - @c -u  last timestamp to print (ms)
+ *   - @c -i  print the block index instead of the rows
+ *
+ *  Only the blocks overlapping the time range are decoded, and in them
+ *  only the requested columns and the timestamps, see slog.h.
+ *
+ *  @date    10/18/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "slog.h"
+
+/**
+ * @brief Parse a comma separated list of column names into a mask.
+ */
+static unsigned column_arg(char *arg)
+{
+    unsigned mask = 0;
+
+    for(char *name = strtok(arg, ","); name; name = strtok(NULL, ","))
+    {
+        int c = 0;
+
+        while(c < SLOG_COLUMNS && strcmp(name, slog_column_name[c]))
+            ++c;
+        if(c == SLOG_COLUMNS)
+        {
+            fprintf(stderr, "slog_cat: no column '%s'\n", name);
+            exit(1);
+        }
+        mask |= 1u << c;
+    }
+    return mask;
+}
+
+static void print_index(const Slog_Reader *r)
+{
+    puts("block,offset,rows,first_ms,last_ms");
+    for(uint32_t i = 0; i < r->blocks; ++i)
+    {
+        Slog_Block b = slog_block(r, i);
+
+        printf("%lu,%llu,%lu,%lu,%lu\n", (unsigned long)i,
+               (unsigned long long)b.offset, (unsigned long)b.rows,
+               (unsigned long)b.first_ms, (unsigned long)b.last_ms);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static int32_t data[SLOG_COLUMNS][SLOG_BLOCK_ROWS];
+    int32_t *out[SLOG_COLUMNS];
+    unsigned mask = (1u << SLOG_COLUMNS) - 1;
+    uint32_t from = 0, until = UINT32_MAX;
+    int index = 0;
+    Slog_Reader r;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:f:u:i")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c':
+                mask = column_arg(optarg);
+                break;
+            case 'f':
+                from = strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                until = strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                index = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-c column[,column...]] [-f ms] "
+                        "[-u ms] [-i] log\n", argv[0]);
+                return 1;
+        }
+    }
+    if(optind != argc-1)
+    {
+        fprintf(stderr, "%s: one log file expected\n", argv[0]);
+        return 1;
+    }
+    if(slog_open(&r, argv[optind]))
+    {
+        fprintf(stderr, "%s\n", r.err);
+        return 1;
+    }
+    if(index)
+    {
+        print_index(&r);
+        slog_unmap(&r);
+        return 0;
+    }
+
+    for(int c = 0, first = 1; c < SLOG_COLUMNS; ++c)
+    {
+        out[c] = data[c];
+        if(mask & 1u << c)
+        {
+            printf("%s%s", first ? "" : ",", slog_column_name[c]);
+            first = 0;
+        }
+    }
+    putchar('\n');
+
+    for(uint32_t i = slog_find(&r, from); i < r.blocks; ++i)
+    {
+        long rows;
+
+        if(slog_block(&r, i).first_ms > until)
+            break;
+        // The timestamps are needed for the range either way
+        rows = slog_decode(&r, i, mask | 1u << SLOG_MS, out);
+        if(rows < 0)
+        {
+            fprintf(stderr, "%s: block %lu is corrupt\n", argv[optind],
+                    (unsigned long)i);
+            slog_unmap(&r);
+            return 1;
+        }
+        for(long n = 0; n < rows; ++n)
+        {
+            uint32_t ms = data[SLOG_MS][n];
+
+            if(ms < from || ms > until)
+                continue;
+            for(int c = 0, first = 1; c < SLOG_COLUMNS; ++c)
+                if(mask & 1u << c)
+                {
+                    if(c == SLOG_MS)
+                        printf("%s%lu", first ? "" : ",", (unsigned long)ms);
+                    else
+                        printf("%s%ld", first ? "" : ",", (long)data[c][n]);
+                    first = 0;
+                }
+            putchar('\n');
+        }
+    }
+    slog_unmap(&r);
+    return 0;
+}
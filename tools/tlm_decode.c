@@ -0,0 +1,295 @@
+/**
+ *  @file
+ *  @brief Host decoder for the binary telemetry stream.
+ *
+ *  Reads a raw serial capture, splits it on the frame delimiter, checks
+ *  each frame and writes the samples either as CSV or as one column file
+ *  per channel. The 16 bit frame timestamps are unwrapped into a 32 bit
+ *  millisecond clock, which holds as long as no gap in the capture is longer
+ *  than 65 seconds.
+ *
+ *  Usage: tlm_decode [-t] [-p ms] [-c prefix] [-l log] [capture]
+ *   - without @c -c or @c -l, CSV goes to stdout
+ *   - with @c -c, each channel is written to prefix.<channel> as a packed
+ *     little-endian array: ms (uint32), mode, gear, throttle, adc (uint8),
+ *     rpms, ave (uint16)
+ *   - with @c -l, the samples are written to a columnar session log, see
+ *     slog.h, which tools/slog_cat.c reads back
+ *   - with @c -t, the capture is the text printout of a build without
+ *     #TELEMETRY instead: each "Current mode / gear / rpms" group is one
+ *     sample. The printout carries no time or throttle, so samples are
+ *     stamped every @c -p ms (2000 by default, the print period) and the
+ *     throttle is 0.
+ *
+ *  A summary of good, bad and missing frames goes to stderr.
+ *
+ *  @date    10/18/2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "telemetry.h"
+#include "slog.h"
+
+#define MAX_BLOCK   64  ///<Longer runs between delimiters are line noise
+#define MAX_LINE    128 ///<Longest text printout line
+#define TEXT_PERIOD 2000    ///<Default print period of the text printout (ms)
+
+/// Column output files, in #Tlm_Sample order.
+enum Column {COL_MS, COL_MODE, COL_GEAR, COL_RPMS, COL_AVE, COL_THROTTLE,
+             COL_ADC, COLUMNS};
+
+static const char *col_name[COLUMNS] =
+    {"ms", "mode", "gear", "rpms", "ave", "throttle", "adc"};
+
+static FILE *col[COLUMNS];
+static Slog_Writer *slog;   ///<Session log, NULL without -l
+
+static unsigned long good, bad, lost;
+
+static void put_le(FILE *f, uint32_t v, int bytes)
+{
+    while(bytes--)
+    {
+        fputc(v & 0xFF, f);
+        v >>= 8;
+    }
+}
+
+static void open_columns(const char *prefix)
+{
+    char path[1024];
+
+    for(int i = 0; i < COLUMNS; ++i)
+    {
+        snprintf(path, sizeof(path), "%s.%s", prefix, col_name[i]);
+        if(!(col[i] = fopen(path, "wb")))
+        {
+            perror(path);
+            exit(1);
+        }
+    }
+}
+
+static void open_log(const char *path)
+{
+    static Slog_Writer w;
+
+    if(slog_create(&w, path))
+    {
+        perror(path);
+        exit(1);
+    }
+    slog = &w;
+}
+
+/**
+ * @brief Add one sample to the session log, marking gear changes.
+ */
+static void log_sample(const Tlm_Sample *s, uint32_t ms)
+{
+    static int have_prev = 0;
+    static uint8_t prev_gear;
+    Slog_Row row;
+
+    row.v[SLOG_MS]       = ms;
+    row.v[SLOG_RPM]      = s->rpms;
+    row.v[SLOG_GEAR]     = s->gear;
+    row.v[SLOG_MODE]     = s->mode;
+    row.v[SLOG_THROTTLE] = s->throttle;
+    row.v[SLOG_SHIFT]    = have_prev ? s->gear - prev_gear : 0;
+    have_prev = 1;
+    prev_gear = s->gear;
+    if(slog_append(slog, &row))
+    {
+        perror("session log");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Write one sample with its unwrapped timestamp.
+ */
+static void emit(const Tlm_Sample *s, uint32_t ms)
+{
+    if(slog)
+        log_sample(s, ms);
+    if(!col[0])
+    {
+        if(!slog)
+            printf("%lu,%u,%u,%u,%u,%u,%u\n", (unsigned long)ms, s->mode,
+                   s->gear, s->rpms, s->ave, s->throttle, s->adc);
+        return;
+    }
+    put_le(col[COL_MS], ms, 4);
+    put_le(col[COL_MODE], s->mode, 1);
+    put_le(col[COL_GEAR], s->gear, 1);
+    put_le(col[COL_RPMS], s->rpms, 2);
+    put_le(col[COL_AVE], s->ave, 2);
+    put_le(col[COL_THROTTLE], s->throttle, 1);
+    put_le(col[COL_ADC], s->adc, 1);
+}
+
+/**
+ * @brief Decode one delimited block.
+ */
+static void frame(const uint8_t *block, uint8_t len)
+{
+    static uint8_t  have_prev = 0, prev_seq;
+    static uint16_t prev_ms;
+    static uint32_t ms;
+    uint8_t raw[MAX_BLOCK];
+    Tlm_Sample s;
+    uint8_t n;
+
+    if(len == 0)
+        return;
+    n = cobs_decode(block, len, raw);
+    if(!tlm_unpack(raw, n, &s))
+    {
+        ++bad;
+        return;
+    }
+
+    if(have_prev)
+    {
+        lost += (uint8_t)(s.seq - prev_seq - 1);
+        ms += (uint16_t)(s.ms - prev_ms);
+    }else
+        ms = s.ms;
+    have_prev = 1;
+    prev_seq = s.seq;
+    prev_ms = s.ms;
+
+    ++good;
+    emit(&s, ms);
+}
+
+/**
+ * @brief Decode the binary stream, frame by frame.
+ */
+static void binary(FILE *in)
+{
+    uint8_t block[MAX_BLOCK];
+    uint8_t len = 0;
+    uint8_t overrun = 0;
+    int c;
+
+    while((c = getc(in)) != EOF)
+    {
+        if(c == TLM_DELIM)
+        {
+            if(overrun)
+                ++bad;
+            else
+                frame(block, len);
+            len = 0;
+            overrun = 0;
+        }else if(len < MAX_BLOCK)
+            block[len++] = c;
+        else
+            overrun = 1;
+    }
+}
+
+/**
+ * @brief Decode the text printout, one sample per group of lines.
+ */
+static void text(FILE *in, uint32_t period)
+{
+    char buf[MAX_LINE];
+    unsigned v, mode = 0, gear = 0;
+    unsigned have = 0;      // Bit 0: mode, bit 1: gear
+    uint32_t ms = 0;
+    Tlm_Sample s;
+
+    memset(&s, 0, sizeof(s));
+    while(fgets(buf, sizeof(buf), in))
+    {
+        // Lines end "\n\r"; the first one follows the start up banner
+        const char *p = strstr(buf, "Current ");
+
+        if(!p)
+            continue;
+        if(sscanf(p, "Current mode = %u", &v) == 1)
+        {
+            mode = v;
+            have |= 1;
+        }else if(sscanf(p, "Current gear = %u", &v) == 1)
+        {
+            gear = v;
+            have |= 2;
+        }else if(sscanf(p, "Current rpms = %u", &v) == 1)
+        {
+            if(have != 3)
+                ++bad;
+            else
+            {
+                s.mode = mode;
+                s.gear = gear;
+                s.rpms = s.ave = v;
+                ++good;
+                emit(&s, ms);
+            }
+            ms += period;
+            have = 0;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t period = TEXT_PERIOD;
+    int is_text = 0;
+    FILE *in = stdin;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:l:p:t")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c':
+                open_columns(optarg);
+                break;
+            case 'l':
+                open_log(optarg);
+                break;
+            case 'p':
+                period = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                is_text = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t] [-p ms] [-c prefix] "
+                        "[-l log] [capture]\n", argv[0]);
+                return 1;
+        }
+    }
+    if(optind < argc && !(in = fopen(argv[optind], "rb")))
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    if(!col[0] && !slog)
+        puts("ms,mode,gear,rpms,ave,throttle,adc");
+
+    if(is_text)
+        text(in, period);
+    else
+        binary(in);
+
+    for(int i = 0; i < COLUMNS; ++i)
+        if(col[i])
+            fclose(col[i]);
+    if(slog && slog_close(slog))
+    {
+        perror("session log");
+        return 1;
+    }
+
+    fprintf(stderr, "frames %lu, bad %lu, lost %lu\n", good, bad, lost);
+    return 0;
+}